@@ -15,20 +15,35 @@
 #endif
 
 CollatzRunner::CollatzRunner() {
+    if (collatz_profile_load(profile, collatz_profile_path())) {
+        ApplyProfile(limit);
+    }
 }
 
 CollatzRunner::~CollatzRunner() {
 }
 
-CollatzResult CollatzRunner::Compute(LogCallback logCallback)
+bool CollatzRunner::ApplyProfile(uint64_t forLimit)
+{
+    const CollatzProfileEntry* e = collatz_profile_lookup(profile, forLimit);
+    if (!e) return false;
+
+    kernel = e->kernel;
+    threadCount = e->threads;
+    if (e->kernel == COLLATZ_KERNEL_HYBRID) interleaveWidth = e->lanes;
+    return true;
+}
+
+template<typename Result>
+Result CollatzRunner::RunPiped(PipeJob job, LogCallback logCallback)
 {
     int result_fds[2], log_fds[2];
     if (pipe(result_fds) != 0 || pipe(log_fds) != 0) {
-        return CollatzResult{};
+        return Result{};
     }
 
-    std::thread log_thread([count = this->threadCount, result_write = result_fds[1], log_write = log_fds[1], lim = this->limit] {
-        collatz_compute_and_write_pipe(count, lim, result_write, log_write);
+    std::thread log_thread([job, result_write = result_fds[1], log_write = log_fds[1]] {
+        job(result_write, log_write);
     });
 
     std::thread worker_thread([log_read = log_fds[0], logCallback]() {
@@ -45,51 +60,83 @@ CollatzResult CollatzRunner::Compute(LogCallback logCallback)
         close(log_read);
     });
 
-    // Read result
-    CollatzResult r{};
-    ssize_t bytes_read = read(result_fds[0], &r, sizeof(r));
-    (void)bytes_read;
+    // Read result; it is larger than a pipe buffer, so it may arrive in pieces
+    Result rs{};
+    char* dst = reinterpret_cast<char*>(&rs);
+    size_t got = 0;
+    while (got < sizeof(rs)) {
+        ssize_t bytes_read = read(result_fds[0], dst + got, static_cast<unsigned int>(sizeof(rs) - got));
+        if (bytes_read <= 0) break;
+        got += static_cast<size_t>(bytes_read);
+    }
+    if (got != sizeof(rs)) rs = Result{};
     close(result_fds[0]);
 
     log_thread.join();
     worker_thread.join();
 
-    return r;
+    return rs;
 }
 
-CollatzResult CollatzRunner::Compute_simd(LogCallback logCallback)
+CollatzResult CollatzRunner::Compute(LogCallback logCallback)
 {
-    int result_fds[2], log_fds[2];
-    if (pipe(result_fds) != 0 || pipe(log_fds) != 0) {
-        return CollatzResult{};
-    }
+    CollatzOptions opts;
+    opts.threads = threadCount;
+    opts.lanes = interleaveWidth;
+    opts.all_seeds = allSeeds;
+    opts.memo_bits = memo ? COLLATZ_MEMO_DEFAULT_BITS : 0;
+    return RunPiped<CollatzResult>([opts, lim = this->limit, reuse = this->reuseRuns](int result_fd, int log_fd) {
+        if (reuse) {
+            collatz_compute_incremental_and_write_pipe(&opts, lim, result_fd, log_fd);
+        } else {
+            collatz_compute_opts_and_write_pipe(&opts, lim, result_fd, log_fd);
+        }
+    }, logCallback);
+}
 
-    std::thread log_thread([count = this->threadCount, result_write = result_fds[1], log_write = log_fds[1], lim = this->limit] {
-        collatz_compute_simd_and_write_pipe(count, lim, result_write, log_write);
-    });
+CollatzResult CollatzRunner::Compute_simd(LogCallback logCallback)
+{
+    return RunPiped<CollatzResult>([count = this->threadCount, lim = this->limit](int result_fd, int log_fd) {
+        collatz_compute_simd_and_write_pipe(count, lim, result_fd, log_fd);
+    }, logCallback);
+}
 
-    std::thread worker_thread([log_read = log_fds[0], logCallback]() {
-        char buf[4096];
-        ssize_t n;
-        while ((n = read(log_read, buf, sizeof(buf) - 1)) > 0) {
-            buf[n] = '\0';
-            std::string message(buf);
+CollatzResult CollatzRunner::Compute_export(const std::string& path, uint32_t peakMode, LogCallback logCallback)
+{
+    return RunPiped<CollatzResult>([count = this->threadCount, lim = this->limit, path, peakMode](int result_fd, int log_fd) {
+        collatz_compute_export_and_write_pipe(count, lim, path.c_str(), peakMode, result_fd, log_fd);
+    }, logCallback);
+}
 
-            if (logCallback) {
-                logCallback(message);
-            }
-        }
-        close(log_read);
-    });
+CollatzResult CollatzRunner::Compute_descent(const std::string& path, LogCallback logCallback)
+{
+    return RunPiped<CollatzResult>([count = this->threadCount, lim = this->limit, path](int result_fd, int log_fd) {
+        collatz_compute_descent_and_write_pipe(count, lim, path.c_str(), result_fd, log_fd);
+    }, logCallback);
+}
 
-    // Read result
-    CollatzResult rs{};
-    ssize_t bytes_read = read(result_fds[0], &rs, sizeof(rs));
-    (void)bytes_read;
-    close(result_fds[0]);
+CollatzResult CollatzRunner::Compute_archive(const std::string& path, LogCallback logCallback)
+{
+    return RunPiped<CollatzResult>([count = this->threadCount, lim = this->limit, path](int result_fd, int log_fd) {
+        collatz_compute_archive_and_write_pipe(count, lim, path.c_str(), result_fd, log_fd);
+    }, logCallback);
+}
 
-    log_thread.join();
-    worker_thread.join();
+CollatzResult CollatzRunner::Autotune(LogCallback logCallback)
+{
+    CollatzResult rs = RunPiped<CollatzResult>([](int result_fd, int log_fd) {
+        collatz_autotune_and_write_pipe(result_fd, log_fd);
+    }, logCallback);
 
+    if (collatz_profile_load(profile, collatz_profile_path())) {
+        ApplyProfile(limit);
+    }
     return rs;
 }
+
+CollatzWideResult CollatzRunner::Compute_wide(CollatzU128 first, uint64_t count, LogCallback logCallback)
+{
+    return RunPiped<CollatzWideResult>([threads = this->threadCount, first, count](int result_fd, int log_fd) {
+        collatz_compute_wide_and_write_pipe(threads, first.hi, first.lo, count, result_fd, log_fd);
+    }, logCallback);
+}
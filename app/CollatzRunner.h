@@ -6,6 +6,12 @@
 #include <limits>
 #include "../lib/collatz.h"
 #include "../lib/collatz_simd.h"
+#include "../lib/collatz_export.h"
+#include "../lib/collatz_archive.h"
+#include "../lib/collatz_tune.h"
+#include "../lib/collatz_perf.h"
+#include "../lib/collatz_wide.h"
+#include "../lib/collatz_summary.h"
 
 class CollatzRunner {
 public:
@@ -14,12 +20,36 @@ public:
 
     uint64_t limit = 9000000000;
     int threadCount = 12;
+    int interleaveWidth = 8; // lanes of the hybrid kernel: 4, 8, 16 or 32
+    bool allSeeds = false;   // hybrid kernel: stats over every seed, not just the odd ones
+    bool reuseRuns = true;   // hybrid kernel: answer from / extend stored runs (collatz_summary.h)
+    bool memo = false;       // hybrid kernel: tail memo of COLLATZ_MEMO_DEFAULT_BITS
+    int kernel = COLLATZ_KERNEL_HYBRID;
+
+    // Host profile from the last autotune, loaded at construction (empty if none)
+    CollatzProfile profile;
+    bool HasProfile() const { return !profile.bands.empty(); }
+    // Take kernel, threads and lanes from the profile band covering limit; false if no profile
+    bool ApplyProfile(uint64_t forLimit);
 
     using LogCallback = std::function<void(const std::string&)>;
     CollatzResult Compute(LogCallback logCallback = nullptr);
     CollatzResult Compute_simd(LogCallback logCallback = nullptr);
+    CollatzResult Compute_export(const std::string& path, uint32_t peakMode = COLLATZ_PEAK_NONE,
+                                 LogCallback logCallback = nullptr);
+    // Export with log16 peaks, reusing the rows already written to skip walks (collatz_export.h)
+    CollatzResult Compute_descent(const std::string& path, LogCallback logCallback = nullptr);
+    CollatzResult Compute_archive(const std::string& path, LogCallback logCallback = nullptr);
+    // Run the trials, save and reload the profile; returns the fastest trial of the top band
+    CollatzResult Autotune(LogCallback logCallback = nullptr);
+    // Odd seeds of first .. first + count - 1 in 128-bit arithmetic
+    CollatzWideResult Compute_wide(CollatzU128 first, uint64_t count, LogCallback logCallback = nullptr);
 
 private:
+    using PipeJob = std::function<void(int result_fd, int log_fd)>;
+    template<typename Result>
+    Result RunPiped(PipeJob job, LogCallback logCallback);
+
     CollatzResult r{};
 };
 #endif // COLLATZ_SOLVER_H
@@ -4,6 +4,9 @@
 #include <QFutureWatcher>
 #include <QMetaObject>
 #include <QComboBox>
+#include <QCheckBox>
+#include <QThread>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -19,8 +22,14 @@ MainWindow::MainWindow(QWidget *parent)
     ui->comboBox->addItem("9 Billion", 9000000000ULL);
     ui->comboBox->setCurrentIndex(1);
 
+    ui->laneComboBox->clear();
+    for (int lanes : COLLATZ_LANE_WIDTHS) {
+        ui->laneComboBox->addItem(QString("%1-Way").arg(lanes), lanes);
+    }
+    ui->laneComboBox->setCurrentIndex(ui->laneComboBox->findData(runner.interleaveWidth));
+
     ui->verticalSlider->setMinimum(1);
-    ui->verticalSlider->setMaximum(12);
+    ui->verticalSlider->setMaximum(std::max(12, QThread::idealThreadCount()));
     ui->verticalSlider->setValue(12);
     ui->sliderLabel->setText(QString("Threads: %1").arg(ui->verticalSlider->value()));
     
@@ -46,9 +55,62 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->radio16Way, &QRadioButton::toggled, this, [this](bool checked) {
         if (checked) {
             algorithmChoice = 2;
-            ui->textEdit->append("Algorithm: 16-Way Parallel\n");
+            ui->textEdit->append(QString("Algorithm: %1-Way Parallel\n").arg(runner.interleaveWidth));
         }
     });
+    connect(ui->laneComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        runner.interleaveWidth = ui->laneComboBox->itemData(index).toInt();
+    });
+    connect(ui->allSeedsCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+        runner.allSeeds = checked;
+    });
+    connect(ui->reuseRunsCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+        runner.reuseRuns = checked;
+    });
+    connect(ui->memoCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+        runner.memo = checked;
+    });
+    connect(ui->comboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        applyProfile(ui->comboBox->itemData(index).toULongLong());
+    });
+
+    if (runner.HasProfile()) {
+        applyProfile(ui->comboBox->currentData().toULongLong());
+    } else {
+        ui->textEdit->append("No host profile yet, press Autotune to create one\n");
+    }
+}
+
+// Move the controls to the profile's choice for this limit; they stay editable afterwards
+void MainWindow::applyProfile(uint64_t limit)
+{
+    if (!runner.ApplyProfile(limit)) return;
+
+    ui->verticalSlider->setValue(runner.threadCount);
+    ui->laneComboBox->setCurrentIndex(ui->laneComboBox->findData(runner.interleaveWidth));
+    if (runner.kernel == COLLATZ_KERNEL_SIMD) {
+        ui->radioSIMD->setChecked(true);
+    } else {
+        ui->radio16Way->setChecked(true);
+    }
+    ui->textEdit->append(QString("Profile: %1, %2 threads\n")
+                             .arg(runner.kernel == COLLATZ_KERNEL_SIMD
+                                      ? QString("SIMD Vector")
+                                      : QString("%1-Way Parallel").arg(runner.interleaveWidth))
+                             .arg(runner.threadCount));
+}
+
+void MainWindow::setRunning(bool running)
+{
+    ui->start->setEnabled(!running);
+    ui->autotune->setEnabled(!running);
+    ui->comboBox->setEnabled(!running);
+    ui->radioSIMD->setEnabled(!running);
+    ui->radio16Way->setEnabled(!running);
+    ui->laneComboBox->setEnabled(!running);
+    ui->allSeedsCheckBox->setEnabled(!running);
+    ui->reuseRunsCheckBox->setEnabled(!running);
+    ui->memoCheckBox->setEnabled(!running);
 }
 
 void MainWindow::sliderValueChanged(int value)
@@ -70,12 +132,9 @@ void MainWindow::on_start_clicked()
 {
     uint64_t count = ui->comboBox->currentData().toULongLong();
 
-    ui->start->setEnabled(false);
-    ui->comboBox->setEnabled(false);
-    ui->radioSIMD->setEnabled(false);
-    ui->radio16Way->setEnabled(false);
-    QString algoName = (algorithmChoice == 1) ? "SIMD Vector" : 
-                       (algorithmChoice == 2) ? "16-Way Parallel" : "8-Way Parallel";
+    setRunning(true);
+    QString algoName = (algorithmChoice == 1) ? QString("SIMD Vector")
+                                              : QString("%1-Way Parallel").arg(runner.interleaveWidth);
     ui->textEdit->append(QString("\nComputing %1 numbers using %2 algorithm...\n").arg(count).arg(algoName));
 
     auto *watcher = new QFutureWatcher<CollatzResult>(this);
@@ -84,12 +143,59 @@ void MainWindow::on_start_clicked()
 
         QString output;
         output.append("\n============ Results ===========\n");
-        output.append("Limit: " + QString::number(result.limit) + "\n");
+        output.append("Limit: " + QString::number(result.limit) +
+                      (result.all_seeds ? " (all seeds)\n" : " (odd seeds)\n"));
         output.append("Seconds: " + QString::number(result.seconds, 'f', 3) + " s\n");
+        output.append(QString("  Cache Build: %1 s, Compute: %2 s, Merge: %3 s\n")
+                          .arg(result.cache_build_seconds, 0, 'f', 3)
+                          .arg(result.compute_seconds, 0, 'f', 3)
+                          .arg(result.merge_seconds, 0, 'f', 3));
         output.append("Throughput: " + QString::number(result.throughput, 'f', 3) + " Billion/sec\n");
         output.append("Max Length: " + QString::number(result.longest_len) +
                       " (seed=" + QString::number(result.longest_seed) + ")\n");
-        output.append("Max Peak: " + QString::number(result.max_peak) + "\n");
+        output.append("Max Peak: " + QString::number(result.max_peak) +
+                      " (seed=" + QString::number(result.max_peak_seed) + ")\n");
+
+        auto appendRecords = [&output](const QString& title, const CollatzRecord* records) {
+            output.append(title + ":\n");
+            for (int k = 0; k < COLLATZ_TOP_K && records[k].seed != 0; ++k) {
+                output.append(QString("  %1. %2 (seed=%3)\n").arg(k + 1)
+                                  .arg(records[k].value).arg(records[k].seed));
+            }
+        };
+        appendRecords("Top Lengths", result.top_longest);
+        appendRecords("Top Peaks", result.top_peaks);
+
+        const CollatzCounters& c = result.counters;
+        if (c.seeds != 0) {
+            output.append(QString("Counters: %1 seeds, %2 steps above cache, %3 cache lookups, "
+                                  "%4 slow path, %5 idle lanes, %6 derived\n")
+                              .arg(c.seeds).arg(c.steps_above_cache).arg(c.cache_lookups)
+                              .arg(c.slow_path).arg(c.idle_lanes).arg(c.derived));
+        }
+        const CollatzMemoStats& m = result.memo;
+        if (m.slots != 0) {
+            double rate = m.lookups ? 100.0 * m.hits / m.lookups : 0.0;
+            output.append(QString("Tail Memo: %1 hits of %2 lookups (%3%), %4 inserts, %5 slots\n")
+                              .arg(m.hits).arg(m.lookups).arg(rate, 0, 'f', 1)
+                              .arg(m.inserts).arg(m.slots));
+        }
+        output.append(QString("Join Wait: %1 s total, %2 s max\n")
+                          .arg(c.join_wait_seconds, 0, 'f', 3)
+                          .arg(c.max_join_wait_seconds, 0, 'f', 3));
+
+        auto appendPerf = [&output](const QString& phase, const CollatzPerfCounts& p) {
+            if (p.samples == 0) return;
+            QStringList parts;
+            for (int e = 0; e < COLLATZ_PERF_EVENTS; ++e) {
+                parts << QString("%1=%2").arg(collatz_perf_event_name(e))
+                             .arg((p.valid & (1u << e)) ? QString::number(p.value[e]) : QString("n/a"));
+            }
+            output.append("Perf " + phase + ": " + parts.join(", ") + "\n");
+        };
+        appendPerf("Cache Build", result.perf_cache_build);
+        appendPerf("Compute", result.perf_compute);
+        appendPerf("Merge", result.perf_merge);
 
         if (result.first_overflow != (uint64_t)INT64_MAX) {
             output.append("Overflow Seed: " + QString::number(result.first_overflow) + "\n");
@@ -98,10 +204,7 @@ void MainWindow::on_start_clicked()
         }
 
         ui->textEdit->append(output);
-        ui->start->setEnabled(true);
-        ui->comboBox->setEnabled(true);
-        ui->radioSIMD->setEnabled(true);
-        ui->radio16Way->setEnabled(true);
+        setRunning(false);
         watcher->deleteLater();
     });
 
@@ -115,16 +218,8 @@ void MainWindow::on_start_clicked()
                                           Qt::QueuedConnection,
                                           Q_ARG(QString, qmsg));
             });
-        } else if (algorithmChoice == 2) {
-            // 16-Way Parallel (currently uses same as 8-Way)
-            return runner.Compute([this](const std::string& msg) {
-                QString qmsg = QString::fromStdString(msg);
-                QMetaObject::invokeMethod(this, "appendLogToUI",
-                                          Qt::QueuedConnection,
-                                          Q_ARG(QString, qmsg));
-            });
         } else {
-            // 8-Way Parallel (default)
+            // N-Way Parallel, width from laneComboBox
             return runner.Compute([this](const std::string& msg) {
                 QString qmsg = QString::fromStdString(msg);
                 QMetaObject::invokeMethod(this, "appendLogToUI",
@@ -137,6 +232,32 @@ void MainWindow::on_start_clicked()
     watcher->setFuture(future);
 }
 
+void MainWindow::on_autotune_clicked()
+{
+    setRunning(true);
+    ui->textEdit->append("\nAutotuning, this takes a minute...\n");
+
+    auto *watcher = new QFutureWatcher<CollatzResult>(this);
+    connect(watcher, &QFutureWatcher<CollatzResult>::finished, this, [this, watcher]() {
+        if (runner.HasProfile()) {
+            applyProfile(ui->comboBox->currentData().toULongLong());
+        }
+        setRunning(false);
+        watcher->deleteLater();
+    });
+
+    QFuture<CollatzResult> future = QtConcurrent::run([this]() {
+        return runner.Autotune([this](const std::string& msg) {
+            QString qmsg = QString::fromStdString(msg);
+            QMetaObject::invokeMethod(this, "appendLogToUI",
+                                      Qt::QueuedConnection,
+                                      Q_ARG(QString, qmsg));
+        });
+    });
+
+    watcher->setFuture(future);
+}
+
 MainWindow::~MainWindow()
 {
     delete ui;
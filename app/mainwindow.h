@@ -21,13 +21,17 @@ signals:
 
 private slots:
     void on_start_clicked();
+    void on_autotune_clicked();
     void exitClicked();
     void sliderValueChanged(int value);
     void appendLogToUI(const QString& message);
 
 private:
+    void applyProfile(uint64_t limit);
+    void setRunning(bool running);
+
     Ui::MainWindow *ui;
     CollatzRunner runner;
-    int algorithmChoice = 0; // 0=Standard(8-Way), 1=SIMD, 2=16-Way
+    int algorithmChoice = 0; // 0=Standard, 1=SIMD, 2=Hybrid Cache (N-Way via laneComboBox)
 };
 #endif // MAINWINDOW_H
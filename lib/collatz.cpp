@@ -12,16 +12,30 @@
 #include <map>
 #include <limits>
 #include <bit>
+#include <utility>
+#include <memory>
+#include <functional>
 #include "platform_compat.h"
 #include "collatz.h"
+#include "collatz_export.h"
+#include "collatz_archive.h"
+#include "collatz_records.h"
+#include "collatz_instrument.h"
+#include "collatz_perf.h"
+#include "collatz_trace.h"
+#include "collatz_summary.h"
+#include "collatz_tune.h"
+#include "collatz_cache.h"
+#include "collatz_memo.h"
+#include "collatz_pool.h"
 
 static std::atomic<bool> collatz_logging_enabled{true};
-static std::atomic<int> global_log_fd{-1};
 
 // ================= HELPER ========================
-// write to log pipe
-static void write_to_log(const std::string& message) {
-    int log_fd = global_log_fd.load(std::memory_order_relaxed);
+// write to the log pipe of a run (-1: console only)
+static void write_to_log(int log_fd, const std::string& message) {
+    if (!collatz_logging_enabled.load(std::memory_order_relaxed)) return;
+    COLLATZ_TRACE_SCOPE("log flush");
     if (log_fd != -1) {
         write(log_fd, message.c_str(), static_cast<unsigned int>(message.length()));
     }
@@ -29,21 +43,13 @@ static void write_to_log(const std::string& message) {
 }
 
 // ================= CONFIGURATION =================
-constexpr uint64_t CACHE_LIMIT = 1ULL << 27; // 128 MB
-constexpr size_t HIST_SIZE = 4096;
+constexpr uint64_t CACHE_LIMIT = COLLATZ_CACHE_LIMIT; // 256 MB of uint16
+constexpr size_t HIST_SIZE = COLLATZ_HIST_SIZE;
+constexpr uint64_t WORK_BLOCK_SEEDS = 1ULL << 22;
 
-// Global Cache
-std::vector<uint16_t> collatz_cache;
-
-// Global Results
-std::atomic<uint64_t> global_first_overflow(INT64_MAX);
-std::atomic<uint64_t> global_max_peak(0);
-std::atomic<uint64_t> global_longest_seed(1);
-std::atomic<uint32_t> global_longest_len(0);
-
-// Global Histogram
-std::mutex histogram_mutex;
-std::map<uint32_t, uint64_t> global_histogram_map;
+// Shared cache (collatz_cache_acquire): built once per process, then only read
+static CollatzCacheTables g_cache;
+static std::mutex g_cache_mutex;
 
 // ================= HELPERS =================
 
@@ -53,18 +59,6 @@ std::map<uint32_t, uint64_t> global_histogram_map;
 #  endif
 #endif
 
-template<typename T>
-inline void atomic_update_max(std::atomic<T>& atom, T val) {
-    T cur = atom.load(std::memory_order_relaxed);
-    while (val > cur) if (atom.compare_exchange_weak(cur, val, std::memory_order_relaxed)) break;
-}
-
-template<typename T>
-inline void atomic_update_min(std::atomic<T>& atom, T val) {
-    T cur = atom.load(std::memory_order_relaxed);
-    while (val < cur) if (atom.compare_exchange_weak(cur, val, std::memory_order_relaxed)) break;
-}
-
 // Platform-independent fast_ctz
 inline int fast_ctz(uint64_t n) {
     if (n == 0) return 0;
@@ -88,78 +82,154 @@ inline int fast_ctz(uint64_t n) {
 #endif
 }
 
+#if defined(_MSC_VER)
+#define COLLATZ_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#else
+#define COLLATZ_PREFETCH(addr) __builtin_prefetch(addr)
+#endif
+
+// Out of line and out of the hot code: rare paths called from the lane loops
+#if defined(_MSC_VER)
+#define COLLATZ_COLD __declspec(noinline)
+#else
+#define COLLATZ_COLD [[gnu::noinline, gnu::cold]]
+#endif
+
 // Threshold where 3*n+1 might overflow INT64_MAX
 constexpr uint64_t SAFE_THRESHOLD = (static_cast<uint64_t>(INT64_MAX) - 1) / 3;
 
 // ================= BUILD CACHE =================
-void build_cache_parallel() {
-    write_to_log("  > Building Cache ... ");
+static void build_cache_parallel(int log_fd) {
+    write_to_log(log_fd, "  > Building Cache ... ");
+    COLLATZ_TRACE_SCOPE("cache build");
     auto start = std::chrono::high_resolution_clock::now();
 
-    collatz_cache.resize(CACHE_LIMIT);
-    collatz_cache[1] = 0;
-
-    unsigned int threads = std::thread::hardware_concurrency();
-    uint64_t phase_size = 100000;
-
-    for (uint64_t phase_start = 2; phase_start < CACHE_LIMIT; phase_start += phase_size) {
-        uint64_t phase_end = std::min(phase_start + phase_size, CACHE_LIMIT);
-        std::vector<std::thread> workers;
-        uint64_t chunk = (phase_end - phase_start + threads - 1) / threads;
-
-        for(unsigned int t = 0; t < threads; ++t) {
-            uint64_t s = phase_start + t * chunk;
-            if (s >= phase_end) break;
-            uint64_t e = std::min(s + chunk, phase_end);
-
-            workers.emplace_back([s, e, phase_start]() {
-                uint16_t* cache = collatz_cache.data();
-                for (uint64_t i = s; i < e; ++i) {
-                    uint64_t n = i;
-                    uint16_t steps = 0;
-                    while (n >= phase_start) {
-                        if ((n & 1) == 0) {
-                            int zeros = fast_ctz(n);
-                            n >>= zeros;
-                            steps += static_cast<uint16_t>(zeros);
-                        } else {
-                            n = (n * 3 + 1) >> 1;
-                            steps += 2;
-                        }
-                    }
-                    cache[i] = steps + cache[n];
-                }
-            });
-        }
-        for(auto& t : workers) t.join();
-    }
+    g_cache.steps.resize(CACHE_LIMIT);
+    g_cache.peaks.resize(CACHE_LIMIT / 2);
+    collatz_cache_fill(g_cache.steps.data(), g_cache.peaks.data(), CACHE_LIMIT,
+                       std::thread::hardware_concurrency());
+    g_cache.peak_max = collatz_peak_log16_upper(*std::max_element(g_cache.peaks.begin(), g_cache.peaks.end()));
 
     auto end = std::chrono::high_resolution_clock::now();
     std::ostringstream oss;
     oss << "Done (" << std::chrono::duration<double>(end - start).count() << "s)\n";
-    write_to_log(oss.str());
+    write_to_log(log_fd, oss.str());
+}
+
+const CollatzCacheTables& collatz_cache_acquire(int log_fd) {
+    std::lock_guard<std::mutex> lock(g_cache_mutex);
+    if (g_cache.steps.size() != CACHE_LIMIT) build_cache_parallel(log_fd);
+    return g_cache;
+}
+
+// Exact max(m, peak of odd n). The log16 entries only bound a peak, so n is walked on
+// until the bound of what is left cannot beat m; that is usually a few steps past the
+// trajectory's high point.
+static uint64_t peak_from_cache(const uint16_t* peaks, uint64_t n, uint64_t m) {
+    for (;;) {
+        if (n < CACHE_LIMIT && collatz_peak_log16_upper(peaks[n >> 1]) <= m) return m;
+        uint64_t next_val = n * 3 + 1;
+        if (next_val > m) m = next_val;
+        n = next_val >> fast_ctz(next_val);
+    }
 }
 
 // ================= WORKER LOGIC =================
 
+// Stretch of odd seeds m = lo..hi of an all-seeds run whose multiples 2^j*m fall in the
+// range for exactly j = j0..j1 (j0 = 0: m itself is in the range). offset is the
+// position of lo when the segments of the run are laid end to end.
+struct SeedSegment {
+    uint64_t lo;
+    uint64_t hi;
+    int j0;
+    int j1;
+    uint64_t offset;
+};
+
+// Odd-seed results of one segment, widened to its even multiples after the merge
+struct SegmentStats {
+    uint64_t histogram[HIST_SIZE] = {0};
+    LongestRecords longest;
+    PeakRecords peaks;
+    uint64_t first_overflow = INT64_MAX;
+};
+
 struct alignas(128) ThreadResult {
     uint64_t histogram[HIST_SIZE] = {0};
-    uint64_t max_seed = 0;
-    uint64_t max_peak = 0;
+    LongestRecords longest;
+    PeakRecords peaks;
+    uint64_t first_overflow = INT64_MAX;
+    CollatzStepMoments moments{};
+    uint64_t peak_bits[64] = {0};
+    CollatzMemoStats memo{};
+    CollatzCounters counters{};
+    CollatzPerfCounts perf{};
+    CollatzClock::time_point finished;
+    std::vector<SegmentStats> segments;     // all-seeds runs only, indexed like CollatzJob::segments
+};
+
+// ================= JOB =================
+// Everything one run owns. Each entry point runs a job of its own, so runs on different
+// threads only share the cache (read-only) and the worker pool.
+struct CollatzJob {
+    int log_fd = -1;
+    bool quiet = false;
+    const CollatzCacheTables* cache = nullptr;
+
+    // Results (merged on the calling thread after the workers are done)
     uint64_t first_overflow = INT64_MAX;
-    uint32_t max_length = 0;
+    LongestRecords top_longest;
+    PeakRecords top_peaks;
+    std::map<uint32_t, uint64_t> histogram;
+
+    // Per-seed output (export mode), indexed by seed >> 1
+    uint16_t* out_steps = nullptr;
+    uint64_t* out_peaks = nullptr;
+    uint16_t* out_peaks_log = nullptr;
+
+    // Walks stop below this power of two. It only rises above CACHE_LIMIT in descent runs,
+    // where the export columns already hold every odd seed below it, and the highest peak
+    // of those seeds then takes the place of the cache's peak_max.
+    uint64_t walk_floor = CACHE_LIMIT;
+    uint64_t walk_peak_max = 0;
+
+    // Seeds 8q+5 take their result from (seed - 1) / 4 instead of being walked
+    // (CollatzOptions::derive)
+    bool derive = false;
+
+    // Compressed archive sink (archive mode) and partition alignment in seeds
+    CollatzArchiveWriter* archive = nullptr;
+    uint64_t partition_align = 1;
+    // Tail memo of the current range; empty unless CollatzOptions::memo_bits is set
+    CollatzMemo memo;
+
+    // One slot per worker of the current range, indexed by thread_id
+    std::vector<ThreadResult> thread_results;
+    // Segments of an all-seeds range (empty otherwise) and their merged results
+    std::vector<SeedSegment> segments;
+    std::vector<SegmentStats> segment_stats;
 };
 
 
+// Instrumented kernels add ODD_STEP_TAG to steps on every 3n+1 step, so the same add
+// also counts odd steps in the high half (step counts stay far below 1 << 16)
+#ifdef COLLATZ_INSTRUMENT
+constexpr uint32_t ODD_STEP_TAG = 1u << 16;
+#else
+constexpr uint32_t ODD_STEP_TAG = 0;
+#endif
+
+template<uint32_t TAG = 0>
 static inline void step_hybrid(uint64_t& n, uint32_t& steps, uint64_t& peak,
-                               uint64_t seed, uint64_t& overflow) {
-    if (n >= CACHE_LIMIT) {
+                               uint64_t seed, uint64_t& overflow, uint64_t floor = CACHE_LIMIT) {
+    if (n >= floor) {
         if (n < SAFE_THRESHOLD) {
             uint64_t next_val = n * 3 + 1;
             if (next_val > peak) peak = next_val;
             int zeros = fast_ctz(next_val);
             n = next_val >> zeros;
-            steps += static_cast<uint32_t>(1 + zeros);
+            steps += static_cast<uint32_t>(1 + zeros) + TAG;
         } else {
 #ifdef NO_INT128
             // Windows
@@ -172,7 +242,7 @@ static inline void step_hybrid(uint64_t& n, uint32_t& steps, uint64_t& peak,
             if (next_val > peak) peak = next_val;
             int zeros = fast_ctz(next_val);
             n = next_val >> zeros;
-            steps += static_cast<uint32_t>(1 + zeros);
+            steps += static_cast<uint32_t>(1 + zeros) + TAG;
 #else
             // Unix/macOS
             unsigned __int128 wide = (unsigned __int128)n * 3 + 1;
@@ -185,106 +255,548 @@ static inline void step_hybrid(uint64_t& n, uint32_t& steps, uint64_t& peak,
             if (next_val > peak) peak = next_val;
             int zeros = fast_ctz(next_val);
             n = next_val >> zeros;
-            steps += static_cast<uint32_t>(1 + zeros);
+            steps += static_cast<uint32_t>(1 + zeros) + TAG;
 #endif
         }
     }
 }
 
 
-void worker_static(uint64_t start, uint64_t end, int thread_id) {
-    ThreadResult res;
-    const uint16_t* cache = collatz_cache.data();
+// Compile-time unrolled loop: f(std::integral_constant<int, K>) for K = 0..N-1
+template<int N, typename F>
+static inline void unroll(F&& f) {
+    [&]<int... K>(std::integer_sequence<int, K...>) {
+        (f(std::integral_constant<int, K>{}), ...);
+    }(std::make_integer_sequence<int, N>{});
+}
+
+// ================= TAIL MEMO =================
+// Checkpoints a lane passed without a hit; they are published once the lane reaches the
+// cache. The lane's running peak restarts at each of them, pre[j] being its peak before
+// value[j], so the peak since any checkpoint is a suffix max at the end.
+constexpr int MEMO_PENDING = 4;
+
+struct MemoPending {
+    uint64_t value[MEMO_PENDING];
+    uint64_t pre[MEMO_PENDING];
+    uint32_t steps[MEMO_PENDING];
+    int count = 0;
+};
+
+COLLATZ_COLD static void memo_visit(const CollatzMemo& memo, uint64_t& n, uint32_t& s, uint64_t& p,
+                                    MemoPending& mp, CollatzMemoStats& st) {
+    if (n < CACHE_LIMIT || !collatz_memo_checkpoint(n)) return;
+    st.lookups++;
+    CollatzMemoEntry e;
+    if (collatz_memo_find(memo, n, e)) {
+        st.hits++;
+        s += e.steps;
+        p = std::max(p, e.peak);
+        n = e.exit;
+        return;
+    }
+    if (mp.count == MEMO_PENDING) return;
+    mp.value[mp.count] = n;
+    mp.pre[mp.count] = p;
+    mp.steps[mp.count] = s;
+    mp.count++;
+    p = n;
+}
+
+// n is the cache entry the lane ended on (0: overflowed, nothing is published); leaves
+// the lane's whole peak in p
+static inline void memo_finish(CollatzMemo& memo, uint64_t n, uint32_t s, uint64_t& p, MemoPending& mp,
+                               CollatzMemoStats& st) {
+    for (int j = mp.count - 1; j >= 0; --j) {
+        if (n) {
+            // The mask drops the ODD_STEP_TAG bits of instrumented builds
+            uint32_t tail = (s - mp.steps[j]) & 0xFFFF;
+            st.inserts += collatz_memo_insert(memo, mp.value[j], CollatzMemoEntry{n, tail, p});
+        }
+        p = std::max(p, mp.pre[j]);
+    }
+    mp.count = 0;
+}
+
+// ================= REDUCERS =================
+// What the kernels know about a seed once its walk is resolved
+struct SeedOutcome {
+    uint64_t seed;
+    uint64_t n;         // odd cache entry the walk ended on, 0 if it overflowed
+    uint32_t steps;
+    uint64_t peak;      // tracked above the cache only; see settle_peak
+};
+
+struct ReduceContext {
+    const uint16_t* peak_cache;     // log16 peak of every odd n a walk can stop on, at n >> 1
+    uint64_t peak_cache_max;        // bound of all of them
+    const uint16_t* cache_peaks;    // the shared cache's peaks, for peak_from_cache
+};
+
+// Exact peak of a seed whose walk tracked peak p and stopped at odd n below the floor
+static inline uint64_t settle_peak(const ReduceContext& ctx, uint64_t p, uint64_t n) {
+    return p >= ctx.peak_cache_max ? p : peak_from_cache(ctx.cache_peaks, n, p);
+}
+
+// A reducer folds seed outcomes into the thread's slot. Kernels take their reducers
+// as a type list, so each combination is its own loop and absent ones compile away.
+// reads_peak_cache asks the kernel to prefetch n's peak entry with its step entry.
+struct ReduceHistogram {
+    static constexpr bool reads_peak_cache = false;
+    static inline void add(ThreadResult& res, const ReduceContext&, const SeedOutcome& o) {
+        if (!o.n) return;
+        res.histogram[o.steps < HIST_SIZE ? o.steps : HIST_SIZE - 1]++;
+    }
+};
+
+struct ReduceLongest {
+    static constexpr bool reads_peak_cache = false;
+    static inline void add(ThreadResult& res, const ReduceContext&, const SeedOutcome& o) {
+        if (res.longest.accepts(o.steps) && o.n) res.longest.push(o.seed, o.steps);
+    }
+};
+
+struct ReducePeaks {
+    static constexpr bool reads_peak_cache = false;
+    static inline void add(ThreadResult& res, const ReduceContext& ctx, const SeedOutcome& o) {
+        // The tracked peak misses whatever the trajectory reached inside the cache:
+        // the cache-wide bound, then n's own bound, filter before the exact peak
+        if (o.n && res.peaks.accepts(std::max(o.peak, ctx.peak_cache_max)) &&
+            res.peaks.accepts(std::max(o.peak, collatz_peak_log16_upper(ctx.peak_cache[o.n >> 1])))) {
+            uint64_t p = settle_peak(ctx, o.peak, o.n);
+            if (res.peaks.accepts(p)) res.peaks.push(o.seed, p);
+        }
+    }
+};
+
+struct ReduceMoments {
+    static constexpr bool reads_peak_cache = false;
+    static inline void add(ThreadResult& res, const ReduceContext&, const SeedOutcome& o) {
+        uint64_t live = o.n != 0;
+        res.moments.seeds += live;
+        res.moments.sum += live * o.steps;
+        res.moments.sum_squares += live * o.steps * o.steps;
+    }
+};
+
+// The log16 code of the peak is exact in its exponent, so no walk is needed
+struct ReducePeakBits {
+    static constexpr bool reads_peak_cache = true;
+    static inline void add(ThreadResult& res, const ReduceContext& ctx, const SeedOutcome& o) {
+        if (!o.n) return;
+        uint16_t code = std::max(collatz_peak_log16(o.peak), ctx.peak_cache[o.n >> 1]);
+        res.peak_bits[code >> 8]++;
+    }
+};
+
+template<typename... R>
+struct Reducers {
+    static constexpr bool reads_peak_cache = (R::reads_peak_cache || ...);
+    static inline void add(ThreadResult& res, const ReduceContext& ctx, const SeedOutcome& o) {
+        (R::add(res, ctx, o), ...);
+    }
+};
+
+// Every run keeps the histogram and records; the CollatzStat reducers come on top
+template<typename... Extra>
+using KernelReducers = Reducers<ReduceHistogram, ReduceLongest, ReducePeaks, Extra...>;
+
+// Seeds staged between the trajectory and gather phases of kernel_range: large enough
+// for the prefetches to land before the batch is read, small enough to stay in L1
+constexpr int STAGE_SEEDS = 256;
+
+struct StageBatch {
+    uint64_t n[STAGE_SEEDS];
+    uint64_t p[STAGE_SEEDS];
+    uint32_t s[STAGE_SEEDS];
+};
 
+// Odd seeds in the order the lanes walk them. SKIP5 leaves out the seeds 8q+5, so each
+// group of four odd seeds from base (8q+1) contributes 8q+1, 8q+3 and 8q+7.
+template<bool SKIP5>
+struct SeedOrder {
+    uint64_t base;
+
+    uint64_t at(uint64_t j) const {
+        if constexpr (!SKIP5) return base + 2 * j;
+        uint64_t q = j / 3;
+        uint32_t r = static_cast<uint32_t>(j - 3 * q);
+        return base + 8 * q + (r == 2 ? 6 : 2 * r);
+    }
+    // Seeds of the order below x (x >= base)
+    uint64_t rank(uint64_t x) const {
+        uint64_t d = x - base;
+        if constexpr (!SKIP5) return (d + 1) / 2;
+        static constexpr uint8_t below[8] = {0, 1, 1, 2, 2, 2, 2, 3};
+        return 3 * (d / 8) + below[d % 8];
+    }
+};
+
+// Runs odd seeds of [start, end] into res through Reduce, LANES trajectories
+// interleaved to hide multiply/ctz latency. If out_steps is set, every seed's result is
+// also written to out_steps[(seed >> 1) - out_base]. MEMO lanes go through the job's
+// memo at every checkpoint. DERIVE ranges read seeds 8q+5 off 2q+1 instead of walking them.
+template<int LANES, typename Reduce, bool MEMO, bool DERIVE = false>
+static void kernel_range(CollatzJob& job, uint64_t start, uint64_t end, ThreadResult& res,
+                         uint16_t* out_steps, uint64_t out_base) {
     if ((start & 1) == 0) start++;
     if (start <= 1) start = 3;
+    if (start > end) return;
+
+    // An odd seed n = 4m + 1 with m odd reaches 3m + 1 in three steps, one step after m
+    // does, so steps(n) = steps(m) + 2 and peak(n) = max(3n + 1, peak(m)) (m > 1). That
+    // only pays if m's result can be read, i.e. m is below the walk floor.
+    if constexpr (!DERIVE) {
+        if (job.derive && start > 5 && (end - 1) / 4 < job.walk_floor && end < SAFE_THRESHOLD) {
+            kernel_range<LANES, Reduce, MEMO, true>(job, start, end, res, out_steps, out_base);
+            return;
+        }
+    }
+
+    const uint16_t* cache = job.cache->steps.data();
+    const uint16_t* walked_steps = job.out_steps;
+    uint64_t* const out_peaks = job.out_peaks;
+    uint16_t* const out_peaks_log = job.out_peaks_log;
+    CollatzMemo& memo = job.memo;
+    // Descent runs stop walks above the cache too; those read the finished export columns
+    const uint64_t floor = job.walk_floor;
+    const bool descent = floor > CACHE_LIMIT;
+    const uint16_t* peak_cache = descent ? out_peaks_log : job.cache->peaks.data();
+    const ReduceContext ctx{peak_cache, std::max(job.cache->peak_max, job.walk_peak_max), job.cache->peaks.data()};
+    const bool prefetch_peaks = Reduce::reads_peak_cache || (out_steps && out_peaks_log);
+    auto steps_entry = [&](uint64_t n) { return n < CACHE_LIMIT ? cache + n : walked_steps + (n >> 1); };
+
+    auto emit = [&](uint64_t seed, uint64_t n, uint32_t s, uint64_t p) {
+        size_t idx = static_cast<size_t>((seed >> 1) - out_base);
+        out_steps[idx] = n ? static_cast<uint16_t>(s) : COLLATZ_STEPS_INVALID;
+        if (out_peaks) out_peaks[idx] = n ? settle_peak(ctx, p, n) : p;
+        else if (out_peaks_log) {
+            out_peaks_log[idx] = n ? std::max(collatz_peak_log16(p), peak_cache[n >> 1]) : collatz_peak_log16(p);
+        }
+    };
+
+    const SeedOrder<DERIVE> order{DERIVE ? (start & ~uint64_t(7)) | 1 : start};
+    uint64_t i = order.rank(start);
+    const uint64_t walked = order.rank(end + 1);
+    CollatzCounters cnt{}; // stays in registers; folded into res at the end
+
+    // Trajectory phase: blocks only step down to the cache and stage the final index.
+    // Gather phase: once a batch is full, resolve its (prefetched) cache reads and
+    // run the reducers and out_steps in one pass.
+    StageBatch st;
+    int staged = 0;
+    uint64_t stage_first = i;
 
-    uint64_t i = start;
-
-    // --- 8-WAY HYBRID MATH ---
-    for (; i + 14 <= end; i += 16) {
-        uint64_t n0 = i,      n1 = i+2,    n2 = i+4,    n3 = i+6;
-        uint64_t n4 = i+8,    n5 = i+10,   n6 = i+12,   n7 = i+14;
-
-        uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, s5 = 0, s6 = 0, s7 = 0;
-        uint64_t p0 = n0, p1 = n1, p2 = n2, p3 = n3, p4 = n4, p5 = n5, p6 = n6, p7 = n7;
-
-        while ((n0|n1|n2|n3|n4|n5|n6|n7) >= CACHE_LIMIT) {
-            step_hybrid(n0, s0, p0, i,    res.first_overflow);
-            step_hybrid(n1, s1, p1, i+2,  res.first_overflow);
-            step_hybrid(n2, s2, p2, i+4,  res.first_overflow);
-            step_hybrid(n3, s3, p3, i+6,  res.first_overflow);
-            step_hybrid(n4, s4, p4, i+8,  res.first_overflow);
-            step_hybrid(n5, s5, p5, i+10, res.first_overflow);
-            step_hybrid(n6, s6, p6, i+12, res.first_overflow);
-            step_hybrid(n7, s7, p7, i+14, res.first_overflow);
+    auto gather = [&]() {
+        for (int j = 0; j < staged; ++j) {
+            uint64_t seed = order.at(stage_first + static_cast<uint64_t>(j));
+            uint64_t n = st.n[j];
+            uint32_t s = st.s[j] + *steps_entry(n);
+            if (out_steps) emit(seed, n, s, st.p[j]);
+            // n == 0 marks an overflowed lane
+            Reduce::add(res, ctx, SeedOutcome{seed, n, s, st.p[j]});
         }
+        staged = 0;
+    };
 
-        s0 += cache[n0]; s1 += cache[n1]; s2 += cache[n2]; s3 += cache[n3];
-        s4 += cache[n4]; s5 += cache[n5]; s6 += cache[n6]; s7 += cache[n7];
+    // --- N-WAY HYBRID MATH ---
+    for (; i + LANES <= walked; i += LANES) {
+        uint64_t n[LANES], p[LANES];
+        uint32_t s[LANES];
+        [[maybe_unused]] MemoPending mp[MEMO ? LANES : 1];
+        unroll<LANES>([&](auto k) { n[k] = order.at(i + k); s[k] = 0; p[k] = n[k]; });
 
-        // Update Histogram
-        auto h_inc = [&](uint32_t s) {
-            size_t idx = s < HIST_SIZE ? s : HIST_SIZE-1;
-            res.histogram[idx]++;
-        };
-        h_inc(s0); h_inc(s1); h_inc(s2); h_inc(s3);
-        h_inc(s4); h_inc(s5); h_inc(s6); h_inc(s7);
+        for (;;) {
+            uint64_t active = 0;
+            unroll<LANES>([&](auto k) { active |= n[k]; });
+            if (active < floor) break;
+#ifdef COLLATZ_INSTRUMENT
+            // The OR of the lanes is a cheap (rarely true) filter for any lane being that high
+            if (active >= SAFE_THRESHOLD) {
+                unroll<LANES>([&](auto k) { cnt.slow_path += n[k] >= SAFE_THRESHOLD; });
+            }
+#endif
+            unroll<LANES>([&](auto k) {
+                step_hybrid<ODD_STEP_TAG>(n[k], s[k], p[k], order.at(i + k), res.first_overflow, floor);
+            });
+            if constexpr (MEMO) {
+                // One rarely taken branch per block step instead of one per lane
+                bool checkpoint = false;
+                unroll<LANES>([&](auto k) { checkpoint |= collatz_memo_checkpoint(n[k]) & (n[k] >= CACHE_LIMIT); });
+                if (checkpoint) unroll<LANES>([&](auto k) { memo_visit(memo, n[k], s[k], p[k], mp[k], res.memo); });
+            }
+        }
+        if constexpr (MEMO) unroll<LANES>([&](auto k) { memo_finish(memo, n[k], s[k], p[k], mp[k], res.memo); });
 
-        // Update Max
-        auto check = [&](uint32_t s, uint64_t seed) {
-            if (s > res.max_length) { res.max_length = s; res.max_seed = seed; }
-        };
-        check(s0, i); check(s1, i+2); check(s2, i+4); check(s3, i+6);
-        check(s4, i+8); check(s5, i+10); check(s6, i+12); check(s7, i+14);
+#ifdef COLLATZ_INSTRUMENT
+        // A lane steps on a prefix of the block's iterations, so the block ran for as
+        // many iterations as its busiest lane took odd steps
+        uint32_t busiest = 0;
+        unroll<LANES>([&](auto k) {
+            uint32_t odd = s[k] >> 16;
+            busiest = std::max(busiest, odd);
+            cnt.steps_above_cache += odd;
+            cnt.idle_lanes -= odd;
+            s[k] &= 0xFFFF;
+        });
+        cnt.idle_lanes += static_cast<uint64_t>(busiest) * LANES;
+#endif
 
-        uint64_t local_peak = std::max({p0, p1, p2, p3, p4, p5, p6, p7});
-        if (local_peak > res.max_peak) res.max_peak = local_peak;
+        // Park the lanes; their cache lines load while the next blocks step
+        if (staged == 0) stage_first = i;
+        unroll<LANES>([&](auto k) {
+            COLLATZ_PREFETCH(steps_entry(n[k]));
+            if (prefetch_peaks) COLLATZ_PREFETCH(peak_cache + (n[k] >> 1));
+            st.n[staged + k] = n[k];
+            st.s[staged + k] = s[k];
+            st.p[staged + k] = p[k];
+        });
+        staged += LANES;
+        COLLATZ_COUNT(cnt, seeds, LANES);
+        COLLATZ_COUNT(cnt, cache_lookups, LANES);
+        if (staged == STAGE_SEEDS) gather();
     }
+    gather();
 
     // Cleanup Remainder
-    for (; i <= end; i += 2) {
-        uint64_t n = i;
+    for (; i < walked; ++i) {
+        const uint64_t seed = order.at(i);
+        uint64_t n = seed;
         uint32_t s = 0;
         uint64_t p = n;
-        while(n >= CACHE_LIMIT) {
-            step_hybrid(n, s, p, i, res.first_overflow);
+        while(n >= floor) {
+            COLLATZ_COUNT(cnt, steps_above_cache, 1);
+            COLLATZ_COUNT(cnt, slow_path, n >= SAFE_THRESHOLD);
+            step_hybrid(n, s, p, seed, res.first_overflow, floor);
             if (n == 0) break;
         }
+        COLLATZ_COUNT(cnt, seeds, 1);
         if (n > 0) {
-            s += cache[n];
-            size_t idx = s < HIST_SIZE ? s : HIST_SIZE-1;
-            res.histogram[idx]++;
-            if (s > res.max_length) { res.max_length = s; res.max_seed = i; }
-            if (p > res.max_peak) res.max_peak = p;
+            COLLATZ_COUNT(cnt, cache_lookups, 1);
+            s += *steps_entry(n);
+            Reduce::add(res, ctx, SeedOutcome{seed, n, s, p});
         }
+        if (out_steps) emit(seed, n, s, p);
     }
 
-    // Merge Results
-    atomic_update_min(global_first_overflow, res.first_overflow);
-    atomic_update_max(global_max_peak, res.max_peak);
+    // Derived seeds: m is the entry a walk would stop on, two steps in with peak 3n + 1.
+    // Their m run through memory in order, so the reads need no prefetch.
+    if constexpr (DERIVE) {
+        uint64_t seed = order.base + 4;
+        if (seed < start) seed += 8;
+        for (; seed <= end; seed += 8) {
+            const uint64_t m = seed >> 2;
+            const uint16_t sm = *steps_entry(m);
+            const uint64_t n = sm == COLLATZ_STEPS_INVALID ? 0 : m;
+            const uint32_t s = 2u + sm;
+            const uint64_t p = 3 * seed + 1;
+            COLLATZ_COUNT(cnt, derived, 1);
+            if (n > 0) Reduce::add(res, ctx, SeedOutcome{seed, n, s, p});
+            if (out_steps) emit(seed, n, s, p);
+        }
+    }
+
+#ifdef COLLATZ_INSTRUMENT
+    collatz_counters_add(res.counters, cnt);
+#endif
+}
+
+// Archive mode: run the range block by block and encode each block as soon as it is filled
+template<int LANES, typename Reduce, bool MEMO>
+static void kernel_archive(CollatzJob& job, uint64_t start, uint64_t end, ThreadResult& res) {
+    CollatzArchiveWriter& archive = *job.archive;
+    const uint64_t block_seeds = archive.header.block_seeds;
+    std::vector<uint16_t> block(block_seeds);
+    std::vector<uint8_t> packed;
+
+    for (uint64_t b = (start >> 1) / block_seeds; ; ++b) {
+        uint64_t first_idx = b * block_seeds;
+        uint64_t b_start = std::max(2 * first_idx + 1, start);
+        uint64_t b_end = std::min(2 * (first_idx + block_seeds), end);
+        if (b_start > end) break;
+
+        COLLATZ_TRACE_SCOPE("block", b_start);
+        block[0] = 0; // seed 1
+        kernel_range<LANES, Reduce, MEMO>(job, b_start, b_end, res, block.data(), first_idx);
+
+        size_t count = static_cast<size_t>(std::min(block_seeds, archive.header.seed_count - first_idx));
+        collatz_archive_encode_block(block.data(), count, packed);
+        collatz_archive_put_block(archive, b, packed);
+    }
+}
 
-    uint32_t cur_len = global_longest_len.load(std::memory_order_relaxed);
-    while (res.max_length > cur_len) {
-        if (global_longest_len.compare_exchange_weak(cur_len, res.max_length,
-                                                     std::memory_order_relaxed)) {
-            global_longest_seed.store(res.max_seed, std::memory_order_relaxed);
-            break;
+// All-seeds mode: start..end are positions in the segments of the run. Each piece runs
+// into a scratch slot that is then folded into the thread's stats for its segment.
+template<int LANES, typename Reduce, bool MEMO>
+static void kernel_segments(CollatzJob& job, uint64_t start, uint64_t end, ThreadResult& res) {
+    auto piece = std::make_unique<ThreadResult>();
+
+    for (size_t k = 0; k < job.segments.size(); ++k) {
+        const SeedSegment& seg = job.segments[k];
+        uint64_t seg_last = seg.offset + (seg.hi - seg.lo);
+        if (seg_last < start || seg.offset > end) continue;
+        uint64_t lo = seg.lo + (std::max(start, seg.offset) - seg.offset);
+        uint64_t hi = seg.lo + (std::min(end, seg_last) - seg.offset);
+
+        for (uint64_t b = lo; b <= hi; b += WORK_BLOCK_SEEDS) {
+            uint64_t b_end = std::min(hi, b + WORK_BLOCK_SEEDS - 1);
+            COLLATZ_TRACE_SCOPE("block", b);
+            kernel_range<LANES, Reduce, MEMO>(job, b, b_end, *piece, nullptr, 0);
+            if (b_end == hi) break;
         }
+
+        SegmentStats& stats = res.segments[k];
+        for (size_t j = 0; j < HIST_SIZE; ++j) stats.histogram[j] += piece->histogram[j];
+        stats.longest.merge(piece->longest);
+        stats.peaks.merge(piece->peaks);
+        stats.first_overflow = std::min(stats.first_overflow, piece->first_overflow);
+        collatz_counters_add(res.counters, piece->counters);
+        res.memo.lookups += piece->memo.lookups;
+        res.memo.hits += piece->memo.hits;
+        res.memo.inserts += piece->memo.inserts;
+
+        std::fill(piece->histogram, piece->histogram + HIST_SIZE, 0);
+        piece->longest.clear();
+        piece->peaks.clear();
+        piece->first_overflow = INT64_MAX;
+        piece->counters = CollatzCounters{};
+        piece->memo = CollatzMemoStats{};
     }
+}
 
-    {
-        std::lock_guard<std::mutex> lock(histogram_mutex);
-        for (size_t j = 0; j < HIST_SIZE; ++j) {
-            if (res.histogram[j] > 0) {
-                global_histogram_map[static_cast<uint32_t>(j)] += res.histogram[j];
-            }
+template<int LANES, typename Reduce, bool MEMO>
+void worker_static(CollatzJob& job, uint64_t start, uint64_t end, int thread_id) {
+    ThreadResult& res = job.thread_results[thread_id];
+
+    if (collatz_trace_on()) collatz_trace_thread_name("worker " + std::to_string(thread_id));
+
+    CollatzPerfSession perf;
+    collatz_perf_begin(perf);
+    if (job.archive) {
+        kernel_archive<LANES, Reduce, MEMO>(job, start, end, res);
+    } else if (!job.segments.empty()) {
+        kernel_segments<LANES, Reduce, MEMO>(job, start, end, res);
+    } else {
+        // Fixed-size blocks (a multiple of every lane width) so a timeline shows progress
+        for (uint64_t b = start; b <= end; b += WORK_BLOCK_SEEDS) {
+            uint64_t b_end = std::min(end, b + WORK_BLOCK_SEEDS - 1);
+            COLLATZ_TRACE_SCOPE("block", b);
+            kernel_range<LANES, Reduce, MEMO>(job, b, b_end, res, job.out_steps, 0);
+            if (b_end == end) break;
         }
     }
+    collatz_perf_end(perf, res.perf);
+    res.finished = CollatzClock::now();
 
     std::ostringstream oss;
     oss << "  ✓ Worker " << thread_id << " finished.\n";
-    write_to_log(oss.str());
+#ifdef COLLATZ_INSTRUMENT
+    oss << "      seeds " << res.counters.seeds << ", steps above cache " << res.counters.steps_above_cache
+        << ", slow path " << res.counters.slow_path << ", idle lanes " << res.counters.idle_lanes << "\n";
+#endif
+    if (!job.quiet) write_to_log(job.log_fd, oss.str());
+}
+
+// Fold one worker's slot into the job; runs on the calling thread after the join
+static void merge_thread_result(CollatzJob& job, ThreadResult& res, CollatzResult& out,
+                                CollatzClock::time_point joined) {
+    COLLATZ_TRACE_SCOPE("merge");
+    job.first_overflow = std::min(job.first_overflow, res.first_overflow);
+
+    job.top_longest.merge(res.longest);
+    job.top_peaks.merge(res.peaks);
+    out.step_moments.seeds += res.moments.seeds;
+    out.step_moments.sum += res.moments.sum;
+    out.step_moments.sum_squares += res.moments.sum_squares;
+    for (int b = 0; b < 64; ++b) out.peak_bits[b] += res.peak_bits[b];
+    out.memo.lookups += res.memo.lookups;
+    out.memo.hits += res.memo.hits;
+    out.memo.inserts += res.memo.inserts;
+
+    for (size_t j = 0; j < HIST_SIZE; ++j) {
+        if (res.histogram[j] > 0) {
+            job.histogram[static_cast<uint32_t>(j)] += res.histogram[j];
+        }
+    }
+
+    for (size_t k = 0; k < res.segments.size(); ++k) {
+        SegmentStats& into = job.segment_stats[k];
+        const SegmentStats& from = res.segments[k];
+        for (size_t j = 0; j < HIST_SIZE; ++j) into.histogram[j] += from.histogram[j];
+        into.longest.merge(from.longest);
+        into.peaks.merge(from.peaks);
+        into.first_overflow = std::min(into.first_overflow, from.first_overflow);
+    }
+
+    collatz_counters_set_join_wait(res.counters, res.finished, joined);
+    collatz_counters_add(out.counters, res.counters);
+    collatz_perf_add(out.perf_compute, res.perf);
+}
+
+// ================= POINT / BATCH QUERY =================
+void collatz_cache_ensure() {
+    collatz_cache_acquire(-1);
+}
+
+const uint16_t* collatz_cache_data() {
+    std::lock_guard<std::mutex> lock(g_cache_mutex);
+    return g_cache.steps.data();
+}
+
+uint64_t collatz_cache_peak(const CollatzCacheTables& cache, uint64_t n, uint64_t m) {
+    return m >= cache.peak_max ? m : peak_from_cache(cache.peaks.data(), n, m);
+}
+
+int collatz_query_batch(const uint64_t* seeds, size_t count, uint16_t* steps_out, uint64_t* peaks_out) {
+    constexpr size_t LANES = 8;
+    const CollatzCacheTables& tables = collatz_cache_acquire(-1);
+    const uint16_t* cache = tables.steps.data();
+    const ReduceContext ctx{tables.peaks.data(), tables.peak_max, tables.peaks.data()};
+
+    for (size_t base = 0; base < count; base += LANES) {
+        size_t lanes = std::min(LANES, count - base);
+        uint64_t n[LANES], p[LANES];
+        uint32_t s[LANES];
+        uint64_t overflow = INT64_MAX;
+
+        // Even seeds collapse onto their odd part; lanes past the batch end idle at n = 1
+        for (size_t k = 0; k < LANES; ++k) {
+            uint64_t seed = k < lanes ? seeds[base + k] : 1;
+            int zeros = fast_ctz(seed);
+            n[k] = seed ? seed >> zeros : 0;
+            s[k] = static_cast<uint32_t>(zeros);
+            p[k] = seed;
+            if (n[k] < CACHE_LIMIT) COLLATZ_PREFETCH(cache + n[k]);
+        }
+
+        uint64_t active = 0;
+        for (size_t k = 0; k < LANES; ++k) active |= n[k];
+        while (active >= CACHE_LIMIT) {
+            active = 0;
+            for (size_t k = 0; k < LANES; ++k) {
+                if (n[k] >= CACHE_LIMIT) {
+                    step_hybrid(n[k], s[k], p[k], k, overflow);
+                    if (n[k] < CACHE_LIMIT) COLLATZ_PREFETCH(cache + n[k]);
+                }
+                active |= n[k];
+            }
+        }
+
+        for (size_t k = 0; k < lanes; ++k) {
+            // n == 0 marks seed 0 or a trajectory that overflowed
+            steps_out[base + k] = n[k] ? static_cast<uint16_t>(s[k] + cache[n[k]]) : COLLATZ_STEPS_INVALID;
+            if (peaks_out) peaks_out[base + k] = n[k] ? settle_peak(ctx, p[k], n[k]) : 0;
+        }
+    }
+    return 0;
+}
+
+int collatz_query_batch(std::span<const uint64_t> seeds, std::span<uint16_t> steps_out,
+                        std::span<uint64_t> peaks_out) {
+    if (steps_out.size() < seeds.size()) return -1;
+    if (!peaks_out.empty() && peaks_out.size() < seeds.size()) return -1;
+    return collatz_query_batch(seeds.data(), seeds.size(), steps_out.data(),
+                               peaks_out.empty() ? nullptr : peaks_out.data());
 }
 
 // ================= MAIN =================
@@ -300,64 +812,370 @@ std::string format_number(uint64_t num) {
     return s;
 }
 
+std::string collatz_result_to_json(const CollatzResult& r) {
+    std::ostringstream js;
+    js << std::setprecision(9);
+
+    auto records = [&js](const char* name, const CollatzRecord* list) {
+        js << "\"" << name << "\":[";
+        for (int k = 0; k < COLLATZ_TOP_K && list[k].seed != 0; ++k) {
+            js << (k ? "," : "") << "{\"seed\":" << list[k].seed << ",\"value\":" << list[k].value << "}";
+        }
+        js << "]";
+    };
+    // Events that could not be opened are null, a phase without perf data is null
+    auto perf = [&js](const char* name, const CollatzPerfCounts& p) {
+        js << "\"" << name << "\":";
+        if (p.samples == 0) { js << "null"; return; }
+        js << "{\"threads\":" << p.samples;
+        for (int e = 0; e < COLLATZ_PERF_EVENTS; ++e) {
+            js << ",\"" << collatz_perf_event_name(e) << "\":";
+            if (p.valid & (1u << e)) js << p.value[e];
+            else js << "null";
+        }
+        js << "}";
+    };
+
+    const CollatzCounters& c = r.counters;
+    js << "{\"limit\":" << r.limit
+       << ",\"seconds\":" << r.seconds
+       << ",\"throughput\":" << r.throughput
+       << ",\"first_overflow\":";
+    if (r.first_overflow == 0 || r.first_overflow == (uint64_t)INT64_MAX) js << "null";
+    else js << r.first_overflow;
+    js << ",\"longest\":{\"seed\":" << r.longest_seed << ",\"len\":" << r.longest_len << "}"
+       << ",\"max_peak\":{\"seed\":" << r.max_peak_seed << ",\"value\":" << r.max_peak << "},";
+    records("top_longest", r.top_longest);
+    js << ",";
+    records("top_peaks", r.top_peaks);
+    // Non-empty buckets only, keyed by step count
+    js << ",\"all_seeds\":" << (r.all_seeds ? "true" : "false") << ",\"histogram\":{";
+    bool first_bucket = true;
+    for (int k = 0; k < COLLATZ_HIST_SIZE; ++k) {
+        if (r.histogram[k] == 0) continue;
+        js << (first_bucket ? "" : ",") << "\"" << k << "\":" << r.histogram[k];
+        first_bucket = false;
+    }
+    js << "}";
+    // Optional stats only when they were computed
+    if (r.stats & COLLATZ_STAT_MOMENTS) {
+        const CollatzStepMoments& m = r.step_moments;
+        js << ",\"step_moments\":{\"seeds\":" << m.seeds << ",\"sum\":" << m.sum
+           << ",\"sum_squares\":" << m.sum_squares << "}";
+    }
+    if (r.memo.slots) {
+        js << ",\"memo\":{\"slots\":" << r.memo.slots << ",\"lookups\":" << r.memo.lookups
+           << ",\"hits\":" << r.memo.hits << ",\"inserts\":" << r.memo.inserts << "}";
+    }
+    if (r.stats & COLLATZ_STAT_PEAK_BITS) {
+        js << ",\"peak_bits\":{";
+        bool first_bit = true;
+        for (int b = 0; b < 64; ++b) {
+            if (r.peak_bits[b] == 0) continue;
+            js << (first_bit ? "" : ",") << "\"" << b << "\":" << r.peak_bits[b];
+            first_bit = false;
+        }
+        js << "}";
+    }
+    js << ",\"phases\":{\"cache_build\":" << r.cache_build_seconds
+       << ",\"compute\":" << r.compute_seconds
+       << ",\"merge\":" << r.merge_seconds << "}"
+       << ",\"counters\":{\"seeds\":" << c.seeds
+       << ",\"steps_above_cache\":" << c.steps_above_cache
+       << ",\"cache_lookups\":" << c.cache_lookups
+       << ",\"slow_path\":" << c.slow_path
+       << ",\"idle_lanes\":" << c.idle_lanes
+       << ",\"derived\":" << c.derived
+       << ",\"join_wait_seconds\":" << c.join_wait_seconds
+       << ",\"max_join_wait_seconds\":" << c.max_join_wait_seconds << "}"
+       << ",\"perf\":{";
+    perf("cache_build", r.perf_cache_build);
+    js << ",";
+    perf("compute", r.perf_compute);
+    js << ",";
+    perf("merge", r.perf_merge);
+    js << "}}";
+    return js.str();
+}
+
+using WorkerFn = void (*)(CollatzJob&, uint64_t, uint64_t, int);
+
+template<int LANES, bool MEMO>
+static WorkerFn select_stats(uint32_t stats) {
+    switch (stats & COLLATZ_STATS_ALL) {
+    case COLLATZ_STAT_MOMENTS:   return worker_static<LANES, KernelReducers<ReduceMoments>, MEMO>;
+    case COLLATZ_STAT_PEAK_BITS: return worker_static<LANES, KernelReducers<ReducePeakBits>, MEMO>;
+    case COLLATZ_STATS_ALL:      return worker_static<LANES, KernelReducers<ReduceMoments, ReducePeakBits>, MEMO>;
+    default:                     return worker_static<LANES, KernelReducers<>, MEMO>;
+    }
+}
+
+template<bool MEMO>
+static WorkerFn select_lanes(int lanes, uint32_t stats) {
+    switch (lanes) {
+    case 4:  return select_stats<4, MEMO>(stats);
+    case 16: return select_stats<16, MEMO>(stats);
+    case 32: return select_stats<32, MEMO>(stats);
+    default: return select_stats<8, MEMO>(stats);
+    }
+}
+
+static WorkerFn select_worker(int lanes, uint32_t stats, bool memo) {
+    return memo ? select_lanes<true>(lanes, stats) : select_lanes<false>(lanes, stats);
+}
+
 int collatz_compute(uint64_t limit, CollatzResult& out, int countThread) {
-    global_first_overflow.store(INT64_MAX);
-    global_max_peak.store(0);
-    global_longest_seed.store(1);
-    global_longest_len.store(0);
-    global_histogram_map.clear();
-    collatz_cache.clear();
+    CollatzOptions opts;
+    opts.threads = countThread;
+    return collatz_compute(limit, out, opts);
+}
 
-    auto start = std::chrono::high_resolution_clock::now();
-    build_cache_parallel();
+// ================= ALL SEEDS =================
+// Every n in [first, last] is 2^j*m with m odd, so walking the odd m whose multiples reach
+// the range is enough. Those m are cut into segments wherever the set of j changes (at
+// ceil(first / 2^k) and floor(last / 2^k) + 1); a segment's stats then shift by each of
+// its j in bulk.
+
+// ceil(v / 2^k)
+static inline uint64_t shift_up(uint64_t v, int k) {
+    return (v >> k) + ((v & ((1ULL << k) - 1)) != 0);
+}
+
+static std::vector<SeedSegment> plan_segments(uint64_t first, uint64_t last) {
+    std::vector<uint64_t> cuts;
+    for (int k = 0; k < 64; ++k) {
+        uint64_t lo = shift_up(first, k);
+        if (lo <= last) cuts.push_back(lo);
+        if ((last >> k) < last) cuts.push_back((last >> k) + 1);
+    }
+    cuts.push_back(1);
+    cuts.push_back(last + 1);
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+    std::vector<SeedSegment> segments;
+    uint64_t offset = 0;
+    for (size_t c = 0; c + 1 < cuts.size(); ++c) {
+        uint64_t lo = cuts[c] | 1;
+        uint64_t hi = cuts[c + 1] - 1;
+        if ((hi & 1) == 0) hi--;
+        if (lo > hi) continue;
+
+        int j0 = 0;
+        while (j0 < 64 && shift_up(first, j0) > lo) ++j0;
+        int j1 = -1;
+        while (j1 < 63 && (last >> (j1 + 1)) >= lo) ++j1;
+        if (j0 > j1) continue;
+
+        segments.push_back({lo, hi, j0, j1, offset});
+        offset += hi - lo + 1;
+    }
+    return segments;
+}
+
+// Fold the merged segment stats into the job, each odd seed once per j of its
+// segment; runs on the calling thread after merge_thread_result
+static void expand_segments(CollatzJob& job, uint64_t first, uint64_t last) {
+    for (size_t k = 0; k < job.segments.size(); ++k) {
+        const SeedSegment& seg = job.segments[k];
+        SegmentStats& stats = job.segment_stats[k];
+
+        // The kernels start at seed 3; seed 1 takes 0 steps and peaks at 1
+        if (seg.lo == 1) {
+            stats.histogram[0]++;
+            stats.longest.push(1, 0);
+            stats.peaks.push(1, 1);
+        }
+
+        for (int j = seg.j0; j <= seg.j1; ++j) {
+            for (size_t s = 0; s < HIST_SIZE; ++s) {
+                if (stats.histogram[s] == 0) continue;
+                job.histogram[static_cast<uint32_t>(std::min(s + static_cast<size_t>(j), HIST_SIZE - 1))] += stats.histogram[s];
+            }
+            // Within a segment every m gets the same shift, so its best m stay the best
+            for (int r = 0; r < stats.longest.count; ++r) {
+                const CollatzRecord& rec = stats.longest.items[r];
+                job.top_longest.push(rec.seed << j, rec.value + j);
+            }
+        }
+
+        // A peak value is held by the smallest seed reaching it: the segment's first multiple
+        for (int r = 0; r < stats.peaks.count; ++r) {
+            const CollatzRecord& rec = stats.peaks.items[r];
+            uint64_t seed = rec.seed << seg.j0;
+            job.top_peaks.push(seed, std::max(rec.value, seed));
+        }
+        if (stats.first_overflow != (uint64_t)INT64_MAX) {
+            job.first_overflow = std::min(job.first_overflow, stats.first_overflow << seg.j0);
+        }
+    }
+
+    // An even seed may peak at itself, above its odd part's peak. Those values are new,
+    // and only seeds at the top of the range can still place among the records.
+    uint64_t n = last & ~1ULL;
+    while (n >= first && n >= 2 && job.top_peaks.accepts(n)) {
+        uint16_t steps;
+        uint64_t peak;
+        collatz_query_batch(&n, 1, &steps, &peak);
+        if (steps != COLLATZ_STEPS_INVALID) job.top_peaks.push(n, peak);
+        n -= 2;
+    }
+}
+
+// Split [first, last] into one task per worker thread, run them on the shared pool, wait
+// for them and merge their slots. Fills the compute and merge phases and the counters of out.
+static void run_range(CollatzJob& job, uint64_t first, uint64_t last, const CollatzOptions& opts,
+                      CollatzResult& out) {
+    // The segments of an all-seeds run only carry the histogram and records
+    const uint32_t stats = opts.all_seeds ? 0 : (opts.stats & COLLATZ_STATS_ALL);
+    WorkerFn worker = select_worker(opts.lanes, stats, opts.memo_bits != 0);
+    const uint64_t range_first = first, range_last = last;
 
-    if (countThread == 0) countThread = 1;
-    int num_threads = countThread;
-    if (limit < static_cast<uint64_t>(num_threads)) {
-        num_threads = static_cast<int>(limit == 0 ? 1 : limit);
+    // All-seeds runs hand the workers positions in the segments instead of seeds
+    job.segments.clear();
+    job.segment_stats.clear();
+    if (opts.all_seeds) {
+        job.segments = plan_segments(first, last);
+        job.segment_stats.assign(job.segments.size(), SegmentStats{});
+        const SeedSegment& tail = job.segments.back();
+        first = 0;
+        last = tail.offset + (tail.hi - tail.lo);
     }
+    out.all_seeds = opts.all_seeds ? 1 : 0;
+    out.stats = stats;
+    collatz_memo_reset(job.memo, opts.memo_bits);
+    job.derive = opts.derive;
+    out.memo.slots = job.memo.bits ? (1ULL << job.memo.bits) : 0;
 
-    std::vector<std::thread> threads;
-    uint64_t chunk = limit / static_cast<uint64_t>(num_threads);
+    uint64_t count = last - first + 1;
+    int num_threads = opts.threads > 0 ? opts.threads : 1;
+    if (count < static_cast<uint64_t>(num_threads)) {
+        num_threads = static_cast<int>(count);
+    }
+
+    job.thread_results.clear();
+    job.thread_results.resize(static_cast<size_t>(num_threads));
+    for (ThreadResult& res : job.thread_results) res.segments.resize(job.segments.size());
+
+    std::vector<std::function<void()>> tasks;
+    uint64_t chunk = count / static_cast<uint64_t>(num_threads);
     if (chunk == 0) chunk = 1;
+    chunk = (chunk + job.partition_align - 1) / job.partition_align * job.partition_align;
+
+    auto compute_start = CollatzClock::now();
+    {
+        COLLATZ_TRACE_SCOPE("compute");
+        for (int i = 0; i < num_threads; ++i) {
+            uint64_t t_start = first + static_cast<uint64_t>(i) * chunk;
+            uint64_t t_end = (i == num_threads - 1) ? last : first + static_cast<uint64_t>(i + 1) * chunk - 1;
+            if (t_start > last) break;
+            if (t_end > last) t_end = last;
+            tasks.emplace_back([worker, &job, t_start, t_end, i] { worker(job, t_start, t_end, i); });
+        }
+        collatz_pool_run(tasks);
+    }
+    auto joined = CollatzClock::now();
 
-    for (int i = 0; i < num_threads; ++i) {
-        uint64_t t_start = static_cast<uint64_t>(i) * chunk + 1;
-        uint64_t t_end = (i == num_threads - 1) ? limit : static_cast<uint64_t>(i + 1) * chunk;
-        if (t_start > limit) break;
-        if (t_end > limit) t_end = limit;
-        threads.emplace_back(worker_static, t_start, t_end, i);
+    CollatzPerfSession perf;
+    collatz_perf_begin(perf);
+    {
+        COLLATZ_TRACE_SCOPE("merge phase");
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            merge_thread_result(job, job.thread_results[i], out, joined);
+        }
+        if (!job.segments.empty()) expand_segments(job, range_first, range_last);
     }
-    for (auto& t: threads) t.join();
+    collatz_memo_reset(job.memo, 0);
+    job.derive = false;
+    collatz_perf_end(perf, out.perf_merge);
+    auto merged = CollatzClock::now();
 
-    auto end = std::chrono::high_resolution_clock::now();
-    double seconds = std::chrono::duration<double>(end - start).count();
+    out.compute_seconds = collatz_seconds_between(compute_start, joined);
+    out.merge_seconds = collatz_seconds_between(joined, merged);
+}
 
-    CollatzResult r{};
+// Records and totals; phases and counters are already in r
+static void fill_result(const CollatzJob& job, CollatzResult& r, uint64_t limit, uint64_t seeds) {
     r.limit = limit;
-    r.seconds = seconds;
-    r.throughput = seconds > 0 ? (static_cast<double>(limit) / seconds / 1e9) : 0.0;
-    r.first_overflow = global_first_overflow.load();
-    r.longest_len = global_longest_len.load();
-    r.longest_seed = global_longest_seed.load();
-    r.max_peak = global_max_peak.load();
-    out = r;
+    r.seconds = r.cache_build_seconds + r.compute_seconds + r.merge_seconds;
+    r.throughput = r.seconds > 0 ? (static_cast<double>(seeds) / r.seconds / 1e9) : 0.0;
+    r.first_overflow = job.first_overflow;
+    job.top_longest.sorted(r.top_longest);
+    job.top_peaks.sorted(r.top_peaks);
+    r.longest_len = static_cast<uint32_t>(r.top_longest[0].value);
+    r.longest_seed = job.top_longest.count ? r.top_longest[0].seed : 1;
+    r.max_peak = r.top_peaks[0].value;
+    r.max_peak_seed = r.top_peaks[0].seed;
+    for (const auto& [steps, seeds_with] : job.histogram) r.histogram[steps] = seeds_with;
+}
+
+// Get the shared cache for a job, timing (and profiling) its build if this job is the
+// one that builds it
+static void job_attach_cache(CollatzJob& job, CollatzResult& out) {
+    // Inherited counters also cover the short-lived build threads
+    CollatzPerfSession perf;
+    collatz_perf_begin(perf, true);
+    auto build_start = CollatzClock::now();
+    job.cache = &collatz_cache_acquire(job.log_fd);
+    collatz_perf_end(perf, out.perf_cache_build);
+    out.cache_build_seconds = collatz_seconds_between(build_start, CollatzClock::now());
+}
+
+static int compute_job(CollatzJob& job, uint64_t limit, CollatzResult& out, const CollatzOptions& opts) {
+    std::string trace_path = collatz_trace_env_path();
+    CollatzTraceSession trace;
+    if (!trace_path.empty()) collatz_trace_start(trace);
+
+    job.quiet = opts.quiet;
+    out = CollatzResult{};
+    job_attach_cache(job, out);
+
+    run_range(job, 1, limit == 0 ? 1 : limit, opts, out);
+
+    fill_result(job, out, limit, limit);
+
+    if (!trace_path.empty()) {
+        collatz_trace_stop(trace);
+        write_to_log(job.log_fd, collatz_trace_write(trace, trace_path) ? "  > Trace written to " + trace_path + "\n"
+                                                                        : "  ✗ Could not write trace " + trace_path + "\n");
+    }
     return 0;
 }
 
+static int compute_range_job(CollatzJob& job, uint64_t first, uint64_t last, CollatzResult& out,
+                             const CollatzOptions& opts) {
+    if (first == 0) first = 1;
+    if (last < first) return -1;
 
-int collatz_compute_and_write_pipe_impl(int countThread, uint64_t limit, int result_fd, int log_fd) {
-    CollatzResult result{};
+    job.quiet = opts.quiet;
+    out = CollatzResult{};
+    job_attach_cache(job, out);
+
+    run_range(job, first, last, opts, out);
+
+    fill_result(job, out, last, last - first + 1);
+    return 0;
+}
 
-    global_log_fd.store(log_fd, std::memory_order_relaxed);
+int collatz_compute(uint64_t limit, CollatzResult& out, const CollatzOptions& opts) {
+    CollatzJob job;
+    return compute_job(job, limit, out, opts);
+}
 
-    int ret = collatz_compute(limit, result, countThread);
+int collatz_compute_range(uint64_t first, uint64_t last, CollatzResult& out, const CollatzOptions& opts) {
+    CollatzJob job;
+    return compute_range_job(job, first, last, out, opts);
+}
+
+void collatz_set_logging_enabled(bool enabled) {
+    collatz_logging_enabled.store(enabled, std::memory_order_relaxed);
+}
 
+static int write_result_to_pipe(const CollatzResult& result, int result_fd, int log_fd) {
     if (result_fd != -1) {
         ssize_t bytes_written = write(result_fd, &result, sizeof(result));
         if (bytes_written != static_cast<ssize_t>(sizeof(result))) {
             close(result_fd);
-            global_log_fd.store(-1, std::memory_order_relaxed);
             return -2;
         }
         close(result_fd);
@@ -366,11 +1184,277 @@ int collatz_compute_and_write_pipe_impl(int countThread, uint64_t limit, int res
     if (log_fd != -1) {
         close(log_fd);
     }
-    global_log_fd.store(-1, std::memory_order_relaxed);
+    return 0;
+}
+
+int collatz_compute_and_write_pipe_impl(int countThread, uint64_t limit, int result_fd, int log_fd) {
+    CollatzResult result{};
+    CollatzJob job;
+    job.log_fd = log_fd;
+
+    CollatzOptions opts;
+    opts.threads = countThread;
+    int ret = compute_job(job, limit, result, opts);
+
+    int pipe_ret = write_result_to_pipe(result, result_fd, log_fd);
+    return pipe_ret != 0 ? pipe_ret : ret;
+}
+
+// ================= EXPORT =================
+static int compute_export_job(CollatzJob& job, uint64_t limit, CollatzResult& out, int countThread,
+                              const std::string& path, uint32_t peak_mode) {
+    CollatzExportFile file;
+    if (!collatz_export_create(file, path, limit, peak_mode)) {
+        write_to_log(job.log_fd, "  ! Cannot create export file " + path + "\n");
+        return -1;
+    }
+
+    job.out_steps = file.steps;
+    job.out_peaks = file.peaks;
+    job.out_peaks_log = file.peaks_log;
+
+    CollatzOptions opts;
+    opts.threads = countThread;
+    int ret = compute_job(job, limit, out, opts);
+
+    job.out_steps = nullptr;
+    job.out_peaks = nullptr;
+    job.out_peaks_log = nullptr;
+    collatz_export_close(file);
+
+    std::ostringstream oss;
+    oss << "  > Exported " << format_number((limit + 1) / 2) << " seeds to " << path << "\n";
+    write_to_log(job.log_fd, oss.str());
+    return ret;
+}
+
+int collatz_compute_export(uint64_t limit, CollatzResult& out, int countThread,
+                           const std::string& path, uint32_t peak_mode) {
+    CollatzJob job;
+    return compute_export_job(job, limit, out, countThread, path, peak_mode);
+}
+
+extern "C" int collatz_compute_export_and_write_pipe(int countThread, uint64_t limit, const char* path,
+                                                     uint32_t peak_mode, int result_fd, int log_fd)
+{
+    CollatzResult result{};
+    CollatzJob job;
+    job.log_fd = log_fd;
+
+    int ret = compute_export_job(job, limit, result, countThread, path, peak_mode);
+
+    int pipe_ret = write_result_to_pipe(result, result_fd, log_fd);
+    return pipe_ret != 0 ? pipe_ret : ret;
+}
+
+// ================= DESCENT =================
+static int compute_descent_job(CollatzJob& job, uint64_t limit, CollatzResult& out, int countThread,
+                               const std::string& path) {
+    CollatzExportFile file;
+    if (limit == 0 || !collatz_export_create(file, path, limit, COLLATZ_PEAK_LOG16, false)) {
+        write_to_log(job.log_fd, "  ! Cannot create descent file " + path + "\n");
+        return -1;
+    }
+
+    out = CollatzResult{};
+    job_attach_cache(job, out);
+
+    job.out_steps = file.steps;
+    job.out_peaks_log = file.peaks_log;
+    CollatzOptions opts;
+    opts.threads = countThread;
+    opts.derive = true;
+    double compute_seconds = 0, merge_seconds = 0;
+
+    // Below the cache, then [2^27, 2^28) as usual; from there on each phase starts at a
+    // power of two and walks down to it
+    uint64_t first = 1, floor = CACHE_LIMIT;
+    while (first <= limit) {
+        uint64_t last = std::min(limit, first < CACHE_LIMIT ? CACHE_LIMIT - 1 : 2 * first - 1);
+        job.walk_floor = floor;
+        if (floor > CACHE_LIMIT) {
+            // Every seed below the floor is merged, so the best peak record bounds them all
+            CollatzRecord top[COLLATZ_TOP_K];
+            job.top_peaks.sorted(top);
+            job.walk_peak_max = top[0].value;
+        }
+        run_range(job, first, last, opts, out);
+        compute_seconds += out.compute_seconds;
+        merge_seconds += out.merge_seconds;
+
+        std::ostringstream oss;
+        oss << "  > Seeds up to " << format_number(last) << " done (walks stop below "
+            << format_number(floor) << ")\n";
+        write_to_log(job.log_fd, oss.str());
+        if (last == limit) break;
+        first = last + 1;
+        floor = first;
+    }
+
+    job.walk_floor = CACHE_LIMIT;
+    job.walk_peak_max = 0;
+    job.out_steps = nullptr;
+    job.out_peaks_log = nullptr;
+    collatz_export_close(file);
+
+    out.compute_seconds = compute_seconds;
+    out.merge_seconds = merge_seconds;
+    fill_result(job, out, limit, limit);
+    return 0;
+}
+
+int collatz_compute_descent(uint64_t limit, CollatzResult& out, int countThread, const std::string& path) {
+    CollatzJob job;
+    return compute_descent_job(job, limit, out, countThread, path);
+}
+
+extern "C" int collatz_compute_descent_and_write_pipe(int countThread, uint64_t limit, const char* path,
+                                                      int result_fd, int log_fd)
+{
+    CollatzResult result{};
+    CollatzJob job;
+    job.log_fd = log_fd;
+
+    int ret = compute_descent_job(job, limit, result, countThread, path);
+
+    int pipe_ret = write_result_to_pipe(result, result_fd, log_fd);
+    return pipe_ret != 0 ? pipe_ret : ret;
+}
+
+// ================= ARCHIVE =================
+static int compute_archive_job(CollatzJob& job, uint64_t limit, CollatzResult& out, int countThread,
+                               const std::string& path) {
+    CollatzArchiveWriter archive;
+    if (!collatz_archive_create(archive, path, limit)) {
+        write_to_log(job.log_fd, "  ! Cannot create archive " + path + "\n");
+        return -1;
+    }
+
+    job.archive = &archive;
+    job.partition_align = 2 * static_cast<uint64_t>(archive.header.block_seeds);
+
+    CollatzOptions opts;
+    opts.threads = countThread;
+    int ret = compute_job(job, limit, out, opts);
+
+    job.archive = nullptr;
+    job.partition_align = 1;
+
+    uint64_t bytes = 0;
+    if (!collatz_archive_finish(archive, &bytes)) {
+        write_to_log(job.log_fd, "  ! Writing archive " + path + " failed\n");
+        return -1;
+    }
 
+    std::ostringstream oss;
+    oss << "  > Archived " << format_number(archive.header.seed_count) << " seeds to " << path
+        << " (" << std::fixed << std::setprecision(2)
+        << (archive.header.seed_count ? 8.0 * static_cast<double>(bytes) / static_cast<double>(archive.header.seed_count) : 0.0)
+        << " bits/seed)\n";
+    write_to_log(job.log_fd, oss.str());
     return ret;
 }
 
+int collatz_compute_archive(uint64_t limit, CollatzResult& out, int countThread,
+                            const std::string& path) {
+    CollatzJob job;
+    return compute_archive_job(job, limit, out, countThread, path);
+}
+
+extern "C" int collatz_compute_archive_and_write_pipe(int countThread, uint64_t limit, const char* path,
+                                                      int result_fd, int log_fd)
+{
+    CollatzResult result{};
+    CollatzJob job;
+    job.log_fd = log_fd;
+
+    int ret = compute_archive_job(job, limit, result, countThread, path);
+
+    int pipe_ret = write_result_to_pipe(result, result_fd, log_fd);
+    return pipe_ret != 0 ? pipe_ret : ret;
+}
+
+// ================= INCREMENTAL =================
+static int compute_incremental_job(CollatzJob& job, uint64_t limit, CollatzResult& out,
+                                   const CollatzOptions& opts) {
+    // Summaries do not carry the optional stats, so those runs always compute in full
+    if (limit < 2 || (opts.stats & COLLATZ_STATS_ALL)) return compute_job(job, limit, out, opts);
+
+    auto load_start = CollatzClock::now();
+    std::string path = collatz_summary_store_path();
+    std::vector<CollatzSummary> store;
+    collatz_summary_load(store, path);  // a missing or outdated store starts empty
+
+    // Longest stored 1..n run with n <= limit that this run can build on
+    const CollatzSummary* base = nullptr;
+    for (const CollatzSummary& s : store) {
+        if (s.kernel != COLLATZ_KERNEL_HYBRID || s.all_seeds != (opts.all_seeds ? 1u : 0u)) continue;
+        if (s.first != 1 || s.last > limit) continue;
+        if (!base || s.last > base->last) base = &s;
+    }
+
+    if (base && base->last == limit) {
+        out = CollatzResult{};
+        collatz_summary_fill_result(*base, out);
+        out.merge_seconds = collatz_seconds_between(load_start, CollatzClock::now());
+        out.seconds = out.merge_seconds;
+        write_to_log(job.log_fd, "  > Answered from the stored run of 1.." + format_number(limit) + "\n");
+        return 0;
+    }
+
+    CollatzSummary summary;
+    int ret;
+    if (base) {
+        write_to_log(job.log_fd, "  > Extending the stored run of 1.." + format_number(base->last) + " to " +
+                                 format_number(limit) + "\n");
+        ret = compute_range_job(job, base->last + 1, limit, out, opts);
+        if (ret != 0) return ret;
+        collatz_summary_from_result(out, base->last + 1, COLLATZ_KERNEL_HYBRID, summary);
+        collatz_summary_merge(summary, *base);
+    } else {
+        ret = compute_job(job, limit, out, opts);
+        if (ret != 0) return ret;
+        collatz_summary_from_result(out, 1, COLLATZ_KERNEL_HYBRID, summary);
+    }
+    // Phases and counters stay those of the seeds computed now
+    collatz_summary_fill_result(summary, out);
+
+    collatz_summary_store_put(store, summary);
+    if (!collatz_summary_save(store, path)) write_to_log(job.log_fd, "  ✗ Could not write " + path + "\n");
+    return 0;
+}
+
+int collatz_compute_incremental(uint64_t limit, CollatzResult& out, const CollatzOptions& opts) {
+    CollatzJob job;
+    return compute_incremental_job(job, limit, out, opts);
+}
+
+extern "C" int collatz_compute_incremental_and_write_pipe(const CollatzOptions* opts, uint64_t limit,
+                                                          int result_fd, int log_fd)
+{
+    CollatzResult result{};
+    CollatzJob job;
+    job.log_fd = log_fd;
+
+    int ret = compute_incremental_job(job, limit, result, opts ? *opts : CollatzOptions{});
+
+    int pipe_ret = write_result_to_pipe(result, result_fd, log_fd);
+    return pipe_ret != 0 ? pipe_ret : ret;
+}
+
+extern "C" int collatz_compute_opts_and_write_pipe(const CollatzOptions* opts, uint64_t limit,
+                                                   int result_fd, int log_fd)
+{
+    CollatzResult result{};
+    CollatzJob job;
+    job.log_fd = log_fd;
+
+    int ret = compute_job(job, limit, result, opts ? *opts : CollatzOptions{});
+
+    int pipe_ret = write_result_to_pipe(result, result_fd, log_fd);
+    return pipe_ret != 0 ? pipe_ret : ret;
+}
+
 extern "C" int collatz_compute_and_write_pipe(int countThread, uint64_t limit, int result_fd, int log_fd)
 {
     return collatz_compute_and_write_pipe_impl(countThread, limit, result_fd, log_fd);
@@ -3,6 +3,78 @@
 
 #include <cstdint>
 #include <string>
+#include <span>
+
+// Step count reported for seeds whose trajectory overflowed
+constexpr uint16_t COLLATZ_STEPS_INVALID = 0xFFFF;
+
+// Number of records kept for the longest trajectories and the highest peaks
+constexpr int COLLATZ_TOP_K = 16;
+
+// Buckets of the step histogram; the last one also holds every longer trajectory
+constexpr int COLLATZ_HIST_SIZE = 4096;
+
+struct CollatzRecord {
+    uint64_t seed;
+    uint64_t value;
+};
+
+// Optional statistics of the hybrid kernel (CollatzOptions::stats). Every combination
+// runs its own specialised kernel, so the ones not asked for cost nothing.
+enum CollatzStat : uint32_t {
+    COLLATZ_STAT_MOMENTS   = 1u << 0,   // count, sum and sum of squares of the step counts
+    COLLATZ_STAT_PEAK_BITS = 1u << 1,   // seeds by floor(log2(peak))
+};
+constexpr uint32_t COLLATZ_STATS_ALL = COLLATZ_STAT_MOMENTS | COLLATZ_STAT_PEAK_BITS;
+
+// Mean and variance of the step counts without the histogram's last-bucket cap
+struct CollatzStepMoments {
+    uint64_t seeds;
+    uint64_t sum;
+    uint64_t sum_squares;
+};
+
+// Tail memo of the hybrid kernel (CollatzOptions::memo_bits), all zero when it is off.
+// Checkpoint values above the cache map to where their trajectory enters the cache, so
+// a trajectory that merges into one already walked skips the rest of the shared tail.
+struct CollatzMemoStats {
+    uint64_t slots;
+    uint64_t lookups;       // checkpoints reached above the cache
+    uint64_t hits;          // lookups that jumped straight to the cache
+    uint64_t inserts;
+};
+
+// Per-thread counters summed over the run. The counts are zero unless collatzlib is
+// built with COLLATZ_INSTRUMENT (the SIMD kernel only counts seeds); join waits are
+// always measured.
+struct CollatzCounters {
+    uint64_t seeds;                 // seeds run through the kernel
+    uint64_t steps_above_cache;     // 3n+1 steps taken while n >= CACHE_LIMIT
+    uint64_t cache_lookups;
+    uint64_t slow_path;             // steps that needed the overflow-checked path
+    uint64_t idle_lanes;            // lane slots spent waiting for the slowest lane of a block
+    uint64_t derived;               // seeds read off a smaller seed instead (CollatzOptions::derive)
+    double join_wait_seconds;       // summed time finished threads waited for the last one
+    double max_join_wait_seconds;
+};
+
+// Hardware events captured per phase when perf counters are enabled (collatz_perf.h)
+enum CollatzPerfEvent {
+    COLLATZ_PERF_CYCLES = 0,
+    COLLATZ_PERF_INSTRUCTIONS,
+    COLLATZ_PERF_BRANCH_MISSES,
+    COLLATZ_PERF_LLC_MISSES,
+    COLLATZ_PERF_DTLB_MISSES,
+    COLLATZ_PERF_EVENTS
+};
+
+// User-space event counts of one phase summed over its threads. Bit e of valid is
+// set only if event e could be opened on every thread that was measured.
+struct CollatzPerfCounts {
+    uint64_t value[COLLATZ_PERF_EVENTS];
+    uint32_t valid;
+    uint32_t samples;               // threads measured
+};
 
 struct CollatzResult {
     uint64_t limit;
@@ -12,19 +84,91 @@ struct CollatzResult {
     uint32_t longest_len;
     uint64_t longest_seed;
     uint64_t max_peak;
+    uint64_t max_peak_seed;
+    // Best first (value desc, ties to the smaller seed); unused slots are zero.
+    // Peaks are distinct values, each with the smallest seed reaching it.
+    CollatzRecord top_longest[COLLATZ_TOP_K];
+    CollatzRecord top_peaks[COLLATZ_TOP_K];
+    // Seeds by step count (hybrid and SIMD kernels, zero elsewhere). Seeds are the odd
+    // ones unless all_seeds is set, in which case every seed of the range is counted.
+    uint64_t histogram[COLLATZ_HIST_SIZE];
+    uint32_t all_seeds;
+    // Optional stats: the CollatzStat bits that were computed, the rest is zero. They
+    // cover odd-seed runs only (an all-seeds run computes none).
+    uint32_t stats;
+    CollatzStepMoments step_moments;
+    uint64_t peak_bits[64];         // peak_bits[b]: seeds with 2^b <= peak < 2^(b+1)
+    CollatzMemoStats memo;
+    // Phases of seconds (seconds = cache_build + compute + merge on every kernel).
+    // cache_build is 0 when the run found the shared cache already built.
+    double cache_build_seconds;
+    double compute_seconds;
+    double merge_seconds;
+    CollatzCounters counters;
+    CollatzPerfCounts perf_cache_build;
+    CollatzPerfCounts perf_compute;     // worker kernels only
+    CollatzPerfCounts perf_merge;
 };
 
+// Interleave widths of the scalar hybrid kernel
+constexpr int COLLATZ_LANE_WIDTHS[] = {4, 8, 16, 32};
+
+struct CollatzOptions {
+    int threads = 1;
+    int lanes = 8;      // one of COLLATZ_LANE_WIDTHS
+    // Also cover even seeds in the histogram and records. They are not walked: an even
+    // seed 2^j*m takes j more steps than its odd part m and peaks at max(2^j*m, peak(m)).
+    bool all_seeds = false;
+    uint32_t stats = 0;     // CollatzStat bits
+    // Share trajectory tails between seeds through a table of 2^memo_bits slots (24
+    // bytes each, freed after the run); 0 is off. Results are the same either way.
+    uint32_t memo_bits = 0;
+    // Read the seeds 8q+5 off 2q+1 (steps + 2) instead of walking them, wherever 2q+1 is
+    // already resolved: below the cache, or below the floor of a descent phase. Results
+    // are the same either way.
+    bool derive = false;
+    // Leave the per-worker lines out of the log (autotune trials)
+    bool quiet = false;
+};
+
+// Table size the app uses when the memo is switched on
+constexpr uint32_t COLLATZ_MEMO_DEFAULT_BITS = 20;
+
+// Each run (hybrid compute, range, export, descent, archive, incremental, and the SIMD
+// and wide kernels) is a job with its own results and log: runs on different threads do
+// not interfere, and share only the step cache (built once, then read-only) and the
+// worker pool (collatz_pool.h).
 extern "C" int collatz_compute(uint64_t limit, CollatzResult& out);
+int collatz_compute(uint64_t limit, CollatzResult& out, int countThread);
+int collatz_compute(uint64_t limit, CollatzResult& out, const CollatzOptions& opts);
+// Seeds first..last only, reusing the cache if it is already built
+int collatz_compute_range(uint64_t first, uint64_t last, CollatzResult& out, const CollatzOptions& opts);
+void collatz_set_logging_enabled(bool enabled);
 int collatz_main(CollatzResult &res);
-void build_cache();
+// Whole result (phases, counters, records, perf) as one JSON object
+std::string collatz_result_to_json(const CollatzResult& r);
 std::string format_number(uint64_t num);
 
+// Build the shared step cache if it is not built yet; it is never rebuilt or freed
+void collatz_cache_ensure();
+// Steps of every n below COLLATZ_CACHE_LIMIT, valid after collatz_cache_ensure()
+constexpr uint64_t COLLATZ_CACHE_LIMIT = 1ULL << 27;
+const uint16_t* collatz_cache_data();
+
+// Steps and peak of arbitrary seeds, filled into caller buffers (peaks may be null/empty).
+// Seed 0 and overflowing seeds report COLLATZ_STEPS_INVALID. Runs on the calling thread;
+// the cache is built on first use only. Safe to call while hybrid runs are going.
+int collatz_query_batch(const uint64_t* seeds, size_t count, uint16_t* steps_out, uint64_t* peaks_out);
+int collatz_query_batch(std::span<const uint64_t> seeds, std::span<uint16_t> steps_out,
+                        std::span<uint64_t> peaks_out = {});
+
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 int collatz_compute_and_write_pipe(int countThread,uint64_t limit, int result_fd, int log_fd);
+int collatz_compute_opts_and_write_pipe(const CollatzOptions* opts, uint64_t limit, int result_fd, int log_fd);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <bit>
+#include "platform_compat.h"
+#include "collatz_archive.h"
+
+// ================= CONFIGURATION =================
+// Symbols are zigzag deltas between neighbouring seeds; large deltas escape to a raw value
+constexpr int NSYM = 512;
+constexpr int ESCAPE = NSYM - 1;
+constexpr int MAX_CODE_LEN = 15;
+constexpr size_t TABLE_BYTES = NSYM / 2; // 4-bit code lengths
+constexpr size_t BLOCK_HEADER_BYTES = 2 + TABLE_BYTES;
+
+static int file_seek(FILE* fp, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(fp, static_cast<__int64>(offset), SEEK_SET);
+#else
+    return fseeko(fp, static_cast<off_t>(offset), SEEK_SET);
+#endif
+}
+
+static inline uint32_t zigzag(int32_t d) {
+    return (static_cast<uint32_t>(d) << 1) ^ static_cast<uint32_t>(d >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t z) {
+    return static_cast<int32_t>(z >> 1) ^ -static_cast<int32_t>(z & 1);
+}
+
+// ================= HUFFMAN =================
+static void build_code_lengths(const uint64_t* freq, uint8_t* lengths) {
+    std::vector<uint64_t> f(freq, freq + NSYM);
+
+    for (;;) {
+        std::fill(lengths, lengths + NSYM, 0);
+
+        // Nodes 0..NSYM-1 are leaves, the rest are internal
+        std::vector<int> parent(2 * NSYM, -1);
+        using Node = std::pair<uint64_t, int>;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> heap;
+        for (int s = 0; s < NSYM; ++s) {
+            if (f[s]) heap.push({f[s], s});
+        }
+        if (heap.empty()) return;
+        if (heap.size() == 1) { lengths[heap.top().second] = 1; return; }
+
+        int next = NSYM;
+        while (heap.size() > 1) {
+            Node a = heap.top(); heap.pop();
+            Node b = heap.top(); heap.pop();
+            parent[a.second] = next;
+            parent[b.second] = next;
+            heap.push({a.first + b.first, next++});
+        }
+
+        int max_len = 0;
+        for (int s = 0; s < NSYM; ++s) {
+            if (!f[s]) continue;
+            int len = 0;
+            for (int n = s; parent[n] != -1; n = parent[n]) ++len;
+            lengths[s] = static_cast<uint8_t>(len);
+            max_len = std::max(max_len, len);
+        }
+        if (max_len <= MAX_CODE_LEN) return;
+
+        // Flatten the distribution until the tree fits the length limit
+        for (auto& v : f) if (v) v = (v + 1) / 2;
+    }
+}
+
+// Canonical codes in (length, symbol) order
+static void assign_codes(const uint8_t* lengths, uint16_t* codes) {
+    int bl_count[MAX_CODE_LEN + 1] = {0};
+    for (int s = 0; s < NSYM; ++s) bl_count[lengths[s]]++;
+    bl_count[0] = 0;
+
+    uint16_t next_code[MAX_CODE_LEN + 2] = {0};
+    uint16_t code = 0;
+    for (int len = 1; len <= MAX_CODE_LEN; ++len) {
+        code = static_cast<uint16_t>((code + bl_count[len - 1]) << 1);
+        next_code[len] = code;
+    }
+    for (int s = 0; s < NSYM; ++s) {
+        if (lengths[s]) codes[s] = next_code[lengths[s]]++;
+    }
+}
+
+// ================= CODEC =================
+void collatz_archive_encode_block(const uint16_t* steps, size_t count, std::vector<uint8_t>& out) {
+    out.clear();
+    if (count == 0) return;
+
+    uint64_t freq[NSYM] = {0};
+    for (size_t i = 1; i < count; ++i) {
+        uint32_t z = zigzag(static_cast<int32_t>(steps[i]) - static_cast<int32_t>(steps[i - 1]));
+        freq[z < ESCAPE ? z : ESCAPE]++;
+    }
+
+    uint8_t lengths[NSYM];
+    uint16_t codes[NSYM] = {0};
+    build_code_lengths(freq, lengths);
+    assign_codes(lengths, codes);
+
+    out.reserve(BLOCK_HEADER_BYTES + count);
+    out.push_back(static_cast<uint8_t>(steps[0] & 0xFF));
+    out.push_back(static_cast<uint8_t>(steps[0] >> 8));
+    for (size_t s = 0; s < NSYM; s += 2) {
+        out.push_back(static_cast<uint8_t>(lengths[s] | (lengths[s + 1] << 4)));
+    }
+
+    uint64_t acc = 0;
+    int nbits = 0;
+    auto put = [&](uint32_t code, int len) {
+        acc = (acc << len) | code;
+        nbits += len;
+        while (nbits >= 8) {
+            nbits -= 8;
+            out.push_back(static_cast<uint8_t>(acc >> nbits));
+        }
+        acc &= (1ULL << nbits) - 1;
+    };
+
+    for (size_t i = 1; i < count; ++i) {
+        uint32_t z = zigzag(static_cast<int32_t>(steps[i]) - static_cast<int32_t>(steps[i - 1]));
+        if (z < ESCAPE) {
+            put(codes[z], lengths[z]);
+        } else {
+            put(codes[ESCAPE], lengths[ESCAPE]);
+            put(steps[i], 16);
+        }
+    }
+    if (nbits > 0) out.push_back(static_cast<uint8_t>(acc << (8 - nbits)));
+}
+
+bool collatz_archive_decode_block(const uint8_t* data, size_t size, size_t count, uint16_t* out) {
+    if (count == 0) return true;
+    if (size < BLOCK_HEADER_BYTES) return false;
+
+    uint8_t lengths[NSYM];
+    for (size_t s = 0; s < NSYM; s += 2) {
+        lengths[s] = data[2 + s / 2] & 0x0F;
+        lengths[s + 1] = data[2 + s / 2] >> 4;
+    }
+
+    // Canonical decode tables: per length, first code and its position in the sorted symbol list
+    int bl_count[MAX_CODE_LEN + 1] = {0};
+    for (int s = 0; s < NSYM; ++s) bl_count[lengths[s]]++;
+    bl_count[0] = 0;
+
+    int first_code[MAX_CODE_LEN + 1] = {0};
+    int first_index[MAX_CODE_LEN + 1] = {0};
+    int code = 0, index = 0;
+    for (int len = 1; len <= MAX_CODE_LEN; ++len) {
+        code = (code + bl_count[len - 1]) << 1;
+        first_code[len] = code;
+        first_index[len] = index;
+        index += bl_count[len];
+    }
+
+    uint16_t sorted[NSYM];
+    int pos = 0;
+    for (int len = 1; len <= MAX_CODE_LEN; ++len) {
+        for (int s = 0; s < NSYM; ++s) {
+            if (lengths[s] == len) sorted[pos++] = static_cast<uint16_t>(s);
+        }
+    }
+
+    const uint8_t* bits = data + BLOCK_HEADER_BYTES;
+    const uint64_t total_bits = static_cast<uint64_t>(size - BLOCK_HEADER_BYTES) * 8;
+    uint64_t bitpos = 0;
+    auto get_bit = [&]() -> int {
+        int b = (bits[bitpos >> 3] >> (7 - (bitpos & 7))) & 1;
+        ++bitpos;
+        return b;
+    };
+
+    out[0] = static_cast<uint16_t>(data[0] | (data[1] << 8));
+    for (size_t i = 1; i < count; ++i) {
+        int c = 0, len = 0, sym = -1;
+        while (len < MAX_CODE_LEN) {
+            if (bitpos >= total_bits) return false;
+            c = (c << 1) | get_bit();
+            ++len;
+            int offset = c - first_code[len];
+            if (offset >= 0 && offset < bl_count[len]) { sym = sorted[first_index[len] + offset]; break; }
+        }
+        if (sym < 0) return false;
+
+        if (sym == ESCAPE) {
+            if (bitpos + 16 > total_bits) return false;
+            uint16_t raw = 0;
+            for (int b = 0; b < 16; ++b) raw = static_cast<uint16_t>((raw << 1) | get_bit());
+            out[i] = raw;
+        } else {
+            out[i] = static_cast<uint16_t>(out[i - 1] + unzigzag(static_cast<uint32_t>(sym)));
+        }
+    }
+    return true;
+}
+
+// ================= WRITER =================
+bool collatz_archive_create(CollatzArchiveWriter& w, const std::string& path, uint64_t limit,
+                            uint32_t block_seeds) {
+    w.fp = std::fopen(path.c_str(), "wb");
+    if (!w.fp) return false;
+
+    std::memset(&w.header, 0, sizeof(w.header));
+    std::memcpy(w.header.magic, "CLZARC1", 8);
+    w.header.version = COLLATZ_ARCHIVE_VERSION;
+    w.header.block_seeds = block_seeds;
+    w.header.limit = limit;
+    w.header.seed_count = (limit + 1) / 2;
+    w.header.block_count = (w.header.seed_count + block_seeds - 1) / block_seeds;
+
+    w.index.assign(static_cast<size_t>(w.header.block_count), CollatzArchiveBlock{0, 0, 0});
+    w.offset = sizeof(CollatzArchiveHeader);
+    w.failed = std::fwrite(&w.header, sizeof(w.header), 1, w.fp) != 1;
+    return !w.failed;
+}
+
+bool collatz_archive_put_block(CollatzArchiveWriter& w, uint64_t block, const std::vector<uint8_t>& data) {
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.failed || block >= w.index.size()) return false;
+
+    if (!data.empty() && std::fwrite(data.data(), data.size(), 1, w.fp) != 1) {
+        w.failed = true;
+        return false;
+    }
+    w.index[static_cast<size_t>(block)] = {w.offset, static_cast<uint32_t>(data.size()), 0};
+    w.offset += data.size();
+    return true;
+}
+
+bool collatz_archive_finish(CollatzArchiveWriter& w, uint64_t* total_bytes) {
+    if (!w.fp) return false;
+
+    bool ok = !w.failed;
+    if (ok) {
+        w.header.index_offset = w.offset;
+        ok = w.index.empty() ||
+             std::fwrite(w.index.data(), sizeof(CollatzArchiveBlock), w.index.size(), w.fp) == w.index.size();
+        ok = ok && file_seek(w.fp, 0) == 0 && std::fwrite(&w.header, sizeof(w.header), 1, w.fp) == 1;
+    }
+    if (total_bytes) *total_bytes = w.offset + w.index.size() * sizeof(CollatzArchiveBlock);
+
+    ok = (std::fclose(w.fp) == 0) && ok;
+    w.fp = nullptr;
+    return ok;
+}
+
+// ================= READER =================
+bool collatz_archive_open(CollatzArchiveReader& r, const std::string& path) {
+    r.fp = std::fopen(path.c_str(), "rb");
+    if (!r.fp) return false;
+
+    bool ok = std::fread(&r.header, sizeof(r.header), 1, r.fp) == 1 &&
+              std::memcmp(r.header.magic, "CLZARC1", 8) == 0 &&
+              r.header.version == COLLATZ_ARCHIVE_VERSION &&
+              r.header.block_seeds > 0 && r.header.index_offset != 0;
+    if (ok) {
+        r.index.resize(static_cast<size_t>(r.header.block_count));
+        ok = file_seek(r.fp, r.header.index_offset) == 0 &&
+             (r.index.empty() ||
+              std::fread(r.index.data(), sizeof(CollatzArchiveBlock), r.index.size(), r.fp) == r.index.size());
+    }
+    if (!ok) collatz_archive_close(r);
+    return ok;
+}
+
+void collatz_archive_close(CollatzArchiveReader& r) {
+    if (r.fp) std::fclose(r.fp);
+    r.fp = nullptr;
+    r.index.clear();
+}
+
+bool collatz_archive_read_range(CollatzArchiveReader& r, uint64_t first_seed, uint64_t last_seed,
+                                std::vector<uint16_t>& out) {
+    out.clear();
+    if (!r.fp || first_seed == 0 || last_seed > r.header.limit || first_seed > last_seed) return false;
+
+    const uint64_t bs = r.header.block_seeds;
+    uint64_t first_idx = first_seed >> 1;
+    uint64_t last_idx = (last_seed - 1) >> 1; // last odd seed <= last_seed
+    if (first_idx > last_idx) return true;
+
+    std::vector<uint8_t> packed;
+    std::vector<uint16_t> block(bs);
+    out.reserve(static_cast<size_t>(last_idx - first_idx + 1));
+
+    for (uint64_t b = first_idx / bs; b <= last_idx / bs; ++b) {
+        const CollatzArchiveBlock& e = r.index[static_cast<size_t>(b)];
+        size_t count = static_cast<size_t>(std::min(bs, r.header.seed_count - b * bs));
+
+        packed.resize(e.size);
+        if (file_seek(r.fp, e.offset) != 0 ||
+            (e.size && std::fread(packed.data(), e.size, 1, r.fp) != 1) ||
+            !collatz_archive_decode_block(packed.data(), packed.size(), count, block.data())) {
+            return false;
+        }
+
+        uint64_t lo = std::max(first_idx, b * bs) - b * bs;
+        uint64_t hi = std::min(last_idx, b * bs + count - 1) - b * bs;
+        out.insert(out.end(), block.begin() + static_cast<ptrdiff_t>(lo),
+                   block.begin() + static_cast<ptrdiff_t>(hi + 1));
+    }
+    return true;
+}
+
+int collatz_archive_steps(CollatzArchiveReader& r, uint64_t seed) {
+    if (seed == 0 || seed > r.header.limit) return -1;
+
+    int zeros = std::countr_zero(seed);
+    uint64_t odd = seed >> zeros;
+
+    std::vector<uint16_t> v;
+    if (!collatz_archive_read_range(r, odd, odd, v) || v.size() != 1) return -1;
+    if (v[0] == COLLATZ_STEPS_INVALID) return -1;
+    return v[0] + zeros;
+}
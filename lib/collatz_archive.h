@@ -0,0 +1,82 @@
+#ifndef COLLATZ_ARCHIVE_H
+#define COLLATZ_ARCHIVE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <mutex>
+#include "collatz.h"
+
+constexpr uint32_t COLLATZ_ARCHIVE_VERSION = 1;
+constexpr uint32_t COLLATZ_ARCHIVE_BLOCK_SEEDS = 65536;
+
+// File layout: header, encoded blocks in completion order, block index at index_offset.
+// Block b holds the step counts of odd seeds with index (seed >> 1) in
+// [b * block_seeds, (b + 1) * block_seeds), delta coded with a per-block Huffman table.
+struct CollatzArchiveHeader {
+    char magic[8];          // "CLZARC1"
+    uint32_t version;
+    uint32_t block_seeds;
+    uint64_t limit;
+    uint64_t seed_count;    // odd seeds 1..limit
+    uint64_t block_count;
+    uint64_t index_offset;
+};
+
+struct CollatzArchiveBlock {
+    uint64_t offset;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+struct CollatzArchiveWriter {
+    FILE* fp = nullptr;
+    CollatzArchiveHeader header{};
+    std::vector<CollatzArchiveBlock> index;
+    std::mutex mutex;
+    uint64_t offset = 0;
+    bool failed = false;
+};
+
+struct CollatzArchiveReader {
+    FILE* fp = nullptr;
+    CollatzArchiveHeader header{};
+    std::vector<CollatzArchiveBlock> index;
+};
+
+// ----- Codec -----
+void collatz_archive_encode_block(const uint16_t* steps, size_t count, std::vector<uint8_t>& out);
+bool collatz_archive_decode_block(const uint8_t* data, size_t size, size_t count, uint16_t* out);
+
+// ----- Writer (put_block is thread safe) -----
+bool collatz_archive_create(CollatzArchiveWriter& w, const std::string& path, uint64_t limit,
+                            uint32_t block_seeds = COLLATZ_ARCHIVE_BLOCK_SEEDS);
+bool collatz_archive_put_block(CollatzArchiveWriter& w, uint64_t block, const std::vector<uint8_t>& data);
+bool collatz_archive_finish(CollatzArchiveWriter& w, uint64_t* total_bytes = nullptr);
+
+// ----- Reader -----
+bool collatz_archive_open(CollatzArchiveReader& r, const std::string& path);
+void collatz_archive_close(CollatzArchiveReader& r);
+// Step counts of the odd seeds in [first_seed, last_seed], decoding only the blocks involved
+bool collatz_archive_read_range(CollatzArchiveReader& r, uint64_t first_seed, uint64_t last_seed,
+                                std::vector<uint16_t>& out);
+// Step count of any seed 1..limit (even seeds resolved from their odd part), -1 on error
+int collatz_archive_steps(CollatzArchiveReader& r, uint64_t seed);
+
+// Run the 8-way engine, encoding each block inside the worker that produced it
+int collatz_compute_archive(uint64_t limit, CollatzResult& out, int countThread,
+                            const std::string& path);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int collatz_compute_archive_and_write_pipe(int countThread, uint64_t limit, const char* path,
+                                           int result_fd, int log_fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COLLATZ_ARCHIVE_H
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <barrier>
+#include <thread>
+#include <vector>
+#include "collatz_cache.h"
+#include "collatz_export.h"
+#include "collatz_trace.h"
+
+// ================= CONFIGURATION =================
+// Odd seeds walked side by side in one block
+constexpr int CACHE_LANES = 16;
+// Below this a phase is too small to be worth splitting
+constexpr uint64_t CACHE_SPLIT_MIN = 1ULL << 16;
+
+// ================= KERNELS =================
+// Odd seeds i, i+2, .. of the span [a, b) in phase [x, 2x). A lane walks until it lands
+// on a finished entry: below i, but not in [x, a) where another thread may still be
+// writing. (3n+1)/2 counts two steps, as in the scalar walks. Lanes that are done keep
+// stepping in place, so the loop has no branches and the compiler turns the lane
+// arrays into vector compares and blends. With PEAKS each lane also keeps the highest
+// 3n+1 it made and only stops on an odd entry, the only ones with a peak stored.
+template<bool PEAKS>
+static void fill_odd_block(uint16_t* cache, uint16_t* peaks, uint64_t i, uint64_t a, uint64_t x) {
+    uint64_t n[CACHE_LANES], s[CACHE_LANES], m[CACHE_LANES];
+    for (int k = 0; k < CACHE_LANES; ++k) {
+        n[k] = i + 2 * k;
+        s[k] = 0;
+        m[k] = n[k];
+    }
+    for (;;) {
+        uint64_t live_any = 0;
+        for (int k = 0; k < CACHE_LANES; ++k) {
+            uint64_t v = n[k];
+            uint64_t odd = v & 1;
+            uint64_t live = 0 - static_cast<uint64_t>((v >= i) | ((v < a) & (v >= x)) | (PEAKS ? (odd ^ 1) : 0));
+            uint64_t next = (v >> 1) + ((v + 1) & (0 - odd));   // (3v+1)/2 if odd, v/2 if even
+            n[k] = v ^ ((v ^ next) & live);
+            s[k] += live & (1 + odd);
+            if (PEAKS) m[k] = std::max(m[k], (2 * next) & (0 - odd) & live);
+            live_any |= live;
+        }
+        if (!live_any) break;
+    }
+    for (int k = 0; k < CACHE_LANES; ++k) cache[i + 2 * k] = static_cast<uint16_t>(s[k] + cache[n[k]]);
+    if (PEAKS) {
+        for (int k = 0; k < CACHE_LANES; ++k) {
+            peaks[(i >> 1) + k] = std::max(collatz_peak_log16(m[k]), peaks[n[k] >> 1]);
+        }
+    }
+}
+
+static void fill_odd_scalar(uint16_t* cache, uint16_t* peaks, uint64_t i, uint64_t a, uint64_t x) {
+    uint64_t n = i;
+    uint64_t m = i;
+    uint32_t steps = 0;
+    while (n >= i || (n < a && n >= x) || (peaks && (n & 1) == 0)) {
+        if (n & 1) { m = std::max(m, 3 * n + 1); n = (3 * n + 1) >> 1; steps += 2; }
+        else       { n >>= 1; steps += 1; }
+    }
+    cache[i] = static_cast<uint16_t>(steps + cache[n]);
+    if (peaks) peaks[i >> 1] = std::max(collatz_peak_log16(m), peaks[n >> 1]);
+}
+
+// Entries [a, b) of phase [x, 2x): evens are one lookup below x, odds go in blocks
+static void fill_span(uint16_t* cache, uint16_t* peaks, uint64_t a, uint64_t b, uint64_t x) {
+    for (uint64_t i = a + (a & 1); i < b; i += 2) cache[i] = static_cast<uint16_t>(cache[i >> 1] + 1);
+
+    uint64_t i = a | 1;
+    for (; i + 2 * (CACHE_LANES - 1) < b; i += 2 * CACHE_LANES) {
+        if (peaks) fill_odd_block<true>(cache, peaks, i, a, x);
+        else       fill_odd_block<false>(cache, peaks, i, a, x);
+    }
+    for (; i < b; i += 2) fill_odd_scalar(cache, peaks, i, a, x);
+}
+
+// ================= PHASES =================
+void collatz_cache_fill(uint16_t* cache, uint16_t* peaks, uint64_t limit, unsigned threads) {
+    if (limit == 0) return;
+    cache[0] = 0;
+    if (limit > 1) cache[1] = 0;
+    if (peaks && limit > 1) peaks[0] = collatz_peak_log16(1);
+    if (limit <= 2) return;
+    if (threads == 0) threads = 1;
+
+    std::barrier sync(static_cast<std::ptrdiff_t>(threads));
+
+    CollatzTraceSession* trace = collatz_trace_current();
+    auto run = [&](unsigned t) {
+        CollatzTraceBind bind(trace);
+        if (t > 0) collatz_trace_thread_name("cache build");
+        for (uint64_t x = 2; x < limit; x *= 2) {
+            uint64_t end = std::min(2 * x, limit);
+            uint64_t len = end - x;
+
+            // Small phases run on thread 0 alone; the others just meet it at the barrier
+            unsigned parts = len < CACHE_SPLIT_MIN ? 1 : threads;
+            if (t < parts) {
+                uint64_t step = 2 * static_cast<uint64_t>(CACHE_LANES);
+                uint64_t chunk = (len / parts + step - 1) / step * step;
+                uint64_t a = x + t * chunk;
+                uint64_t b = (t == parts - 1) ? end : std::min(end, a + chunk);
+                if (a < b) {
+                    COLLATZ_TRACE_SCOPE("cache phase", x);
+                    fill_span(cache, peaks, a, b, x);
+                }
+            }
+            sync.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) workers.emplace_back(run, t);
+    run(0);
+    for (auto& w : workers) w.join();
+}
@@ -0,0 +1,32 @@
+#ifndef COLLATZ_CACHE_H
+#define COLLATZ_CACHE_H
+
+#include <cstdint>
+#include <vector>
+
+// Fills cache[0..limit) with the step count of every n below limit (cache[0] = 0).
+// Works in doubling phases [x, 2x): a seed there is walked only until it drops below
+// x, so a phase reads finished entries only. The threads live across all phases and
+// meet at a barrier between them; even seeds are one lookup, odd ones are walked in
+// blocks of lanes without branches. limit may be anything up to 2^40.
+// If peaks is set, peaks[n >> 1] also receives collatz_peak_log16 of the highest value
+// on the trajectory of every odd n below limit (n itself included); limit / 2 entries.
+void collatz_cache_fill(uint16_t* cache, uint16_t* peaks, uint64_t limit, unsigned threads);
+
+// Step and peak tables every kernel reads, shared by all runs in the process
+struct CollatzCacheTables {
+    std::vector<uint16_t> steps;
+    // Peaks below the cache: collatz_peak_log16 of the highest value on the trajectory of
+    // each odd n < COLLATZ_CACHE_LIMIT (n included), at n >> 1
+    std::vector<uint16_t> peaks;
+    uint64_t peak_max = 0;      // no seed below the cache peaks above this
+};
+
+// The shared tables, built by the first run that needs them (logged to log_fd, -1 for
+// the console only); later runs, and runs that waited for that build, get them as is.
+// They are never rebuilt or freed, so runs read them without locks.
+const CollatzCacheTables& collatz_cache_acquire(int log_fd);
+// Exact max(m, highest value on the trajectory of odd n < COLLATZ_CACHE_LIMIT)
+uint64_t collatz_cache_peak(const CollatzCacheTables& cache, uint64_t n, uint64_t m);
+
+#endif // COLLATZ_CACHE_H
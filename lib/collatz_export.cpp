@@ -0,0 +1,175 @@
+#include <cerrno>
+#include <cstring>
+#include "platform_compat.h"
+#include "collatz_export.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static uint64_t align_up(uint64_t v, uint64_t a) {
+    return (v + a - 1) / a * a;
+}
+
+static void bind_columns(CollatzExportFile& file) {
+    uint8_t* base = static_cast<uint8_t*>(file.base);
+    file.header = reinterpret_cast<CollatzExportHeader*>(base);
+    file.steps = reinterpret_cast<uint16_t*>(base + file.header->steps_offset);
+    file.peaks = nullptr;
+    file.peaks_log = nullptr;
+    if (file.header->peak_mode == COLLATZ_PEAK_U64) {
+        file.peaks = reinterpret_cast<uint64_t*>(base + file.header->peaks_offset);
+    } else if (file.header->peak_mode == COLLATZ_PEAK_LOG16) {
+        file.peaks_log = reinterpret_cast<uint16_t*>(base + file.header->peaks_offset);
+    }
+}
+
+// ================= PLATFORM MAPPING =================
+#ifdef _WIN32
+
+static bool map_file(CollatzExportFile& file, const std::string& path, uint64_t size, bool create,
+                     bool /*reserve*/) {
+    HANDLE h = CreateFileA(path.c_str(), create ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                           FILE_SHARE_READ, nullptr, create ? CREATE_ALWAYS : OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+
+    if (!create) {
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(h, &sz)) { CloseHandle(h); return false; }
+        size = static_cast<uint64_t>(sz.QuadPart);
+    }
+
+    HANDLE m = CreateFileMappingA(h, nullptr, create ? PAGE_READWRITE : PAGE_READONLY,
+                                  static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+    if (!m) { CloseHandle(h); return false; }
+
+    void* base = MapViewOfFile(m, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (!base) { CloseHandle(m); CloseHandle(h); return false; }
+
+    file.file_handle = h;
+    file.map_handle = m;
+    file.base = base;
+    file.size = static_cast<size_t>(size);
+    return true;
+}
+
+void collatz_export_close(CollatzExportFile& file) {
+    if (file.base) {
+        FlushViewOfFile(file.base, 0);
+        UnmapViewOfFile(file.base);
+    }
+    if (file.map_handle) CloseHandle(static_cast<HANDLE>(file.map_handle));
+    if (file.file_handle) CloseHandle(static_cast<HANDLE>(file.file_handle));
+    file = CollatzExportFile{};
+}
+
+#else
+
+static bool map_file(CollatzExportFile& file, const std::string& path, uint64_t size, bool create,
+                     bool reserve) {
+    int fd = create ? open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                    : open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    if (create) {
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) { close(fd); return false; }
+#ifdef __linux__
+        // Reserve the blocks up front so workers never fault on allocation mid-run. A full
+        // disk fails here rather than as SIGBUS in a worker; file systems that cannot
+        // preallocate get a sparse file instead.
+        if (reserve) {
+            int err = posix_fallocate(fd, 0, static_cast<off_t>(size));
+            if (err != 0 && err != EOPNOTSUPP && err != EINVAL) { close(fd); return false; }
+        }
+#endif
+    } else {
+        struct stat st;
+        if (fstat(fd, &st) != 0) { close(fd); return false; }
+        size = static_cast<uint64_t>(st.st_size);
+    }
+
+    void* base = mmap(nullptr, size, create ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                      MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) { close(fd); return false; }
+
+    file.fd = fd;
+    file.base = base;
+    file.size = static_cast<size_t>(size);
+    return true;
+}
+
+void collatz_export_close(CollatzExportFile& file) {
+    if (file.base) {
+        msync(file.base, file.size, MS_ASYNC);
+        munmap(file.base, file.size);
+    }
+    if (file.fd != -1) close(file.fd);
+    file = CollatzExportFile{};
+}
+
+#endif
+
+// ================= CREATE / OPEN =================
+bool collatz_export_create(CollatzExportFile& file, const std::string& path,
+                           uint64_t limit, uint32_t peak_mode, bool reserve) {
+    CollatzExportHeader hdr{};
+    std::memcpy(hdr.magic, "CLZCOL1", 8);
+    hdr.version = COLLATZ_EXPORT_VERSION;
+    hdr.peak_mode = peak_mode;
+    hdr.limit = limit;
+    hdr.seed_count = (limit + 1) / 2;
+    hdr.steps_offset = COLLATZ_EXPORT_ALIGN;
+
+    uint64_t end = hdr.steps_offset + hdr.seed_count * sizeof(uint16_t);
+    if (peak_mode == COLLATZ_PEAK_U64 || peak_mode == COLLATZ_PEAK_LOG16) {
+        hdr.peaks_offset = align_up(end, COLLATZ_EXPORT_ALIGN);
+        end = hdr.peaks_offset + hdr.seed_count *
+              (peak_mode == COLLATZ_PEAK_U64 ? sizeof(uint64_t) : sizeof(uint16_t));
+    } else {
+        hdr.peak_mode = COLLATZ_PEAK_NONE;
+    }
+
+    if (!map_file(file, path, align_up(end, COLLATZ_EXPORT_ALIGN), true, reserve)) return false;
+
+    std::memcpy(file.base, &hdr, sizeof(hdr));
+    bind_columns(file);
+
+    // Seed 1 is never handed to a worker
+    if (hdr.seed_count > 0) {
+        file.steps[0] = 0;
+        if (file.peaks) file.peaks[0] = 1;
+        if (file.peaks_log) file.peaks_log[0] = collatz_peak_log16(1);
+    }
+    return true;
+}
+
+// Every column named in the header lies inside the file
+static bool columns_fit(const CollatzExportHeader& hdr, uint64_t size) {
+    if (hdr.seed_count > size) return false;    // keeps the products below from wrapping
+    if (hdr.steps_offset > size || hdr.seed_count * sizeof(uint16_t) > size - hdr.steps_offset) return false;
+    if (hdr.peak_mode == COLLATZ_PEAK_NONE) return true;
+    if (hdr.peak_mode != COLLATZ_PEAK_U64 && hdr.peak_mode != COLLATZ_PEAK_LOG16) return false;
+
+    uint64_t width = hdr.peak_mode == COLLATZ_PEAK_U64 ? sizeof(uint64_t) : sizeof(uint16_t);
+    uint64_t steps_end = hdr.steps_offset + hdr.seed_count * sizeof(uint16_t);
+    return hdr.peaks_offset >= steps_end && hdr.peaks_offset % COLLATZ_EXPORT_ALIGN == 0 &&
+           hdr.peaks_offset <= size && hdr.seed_count * width <= size - hdr.peaks_offset;
+}
+
+bool collatz_export_open(CollatzExportFile& file, const std::string& path) {
+    if (!map_file(file, path, 0, false, false)) return false;
+
+    const CollatzExportHeader* hdr = static_cast<const CollatzExportHeader*>(file.base);
+    if (file.size < sizeof(CollatzExportHeader) ||
+        std::memcmp(hdr->magic, "CLZCOL1", 8) != 0 ||
+        hdr->version != COLLATZ_EXPORT_VERSION ||
+        !columns_fit(*hdr, file.size)) {
+        collatz_export_close(file);
+        return false;
+    }
+    bind_columns(file);
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef COLLATZ_EXPORT_H
+#define COLLATZ_EXPORT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <bit>
+#include "collatz.h"
+
+// Peak column stored next to the steps column
+enum CollatzPeakMode : uint32_t {
+    COLLATZ_PEAK_NONE  = 0,
+    COLLATZ_PEAK_U64   = 1,
+    COLLATZ_PEAK_LOG16 = 2
+};
+
+constexpr uint32_t COLLATZ_EXPORT_VERSION = 1;
+constexpr uint64_t COLLATZ_EXPORT_ALIGN = 4096;
+
+// On-disk layout: header, then one fixed-width entry per odd seed (index = seed >> 1)
+// in each column. Columns are page aligned so readers can mmap them directly.
+struct CollatzExportHeader {
+    char magic[8];          // "CLZCOL1"
+    uint32_t version;
+    uint32_t peak_mode;     // CollatzPeakMode
+    uint64_t limit;
+    uint64_t seed_count;    // odd seeds 1..limit
+    uint64_t steps_offset;  // uint16 per seed, COLLATZ_STEPS_INVALID on overflow
+    uint64_t peaks_offset;  // uint64 or log16 per seed, 0 if no peak column
+};
+
+struct CollatzExportFile {
+    CollatzExportHeader* header = nullptr;
+    uint16_t* steps = nullptr;
+    uint64_t* peaks = nullptr;
+    uint16_t* peaks_log = nullptr;
+    void* base = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* map_handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// Log-compressed peak: high byte = floor(log2(peak)), low byte = next 8 mantissa bits.
+// Monotone in peak; decoding returns the lower bound of the bucket.
+inline uint16_t collatz_peak_log16(uint64_t peak) {
+    if (peak == 0) return 0;
+    int e = 63 - std::countl_zero(peak);
+    uint64_t frac = (e >= 8) ? (peak >> (e - 8)) : (peak << (8 - e));
+    return static_cast<uint16_t>((e << 8) | (frac & 0xFF));
+}
+
+inline uint64_t collatz_peak_from_log16(uint16_t code) {
+    int e = code >> 8;
+    uint64_t mant = 0x100 | (code & 0xFF);
+    return (e >= 8) ? (mant << (e - 8)) : (mant >> (8 - e));
+}
+
+// Largest peak with this code (peaks below 512 are coded exactly)
+inline uint64_t collatz_peak_log16_upper(uint16_t code) {
+    int e = code >> 8;
+    uint64_t mant = 0x100 | (code & 0xFF);
+    return (e >= 8) ? ((mant + 1) << (e - 8)) - 1 : (mant >> (8 - e));
+}
+
+// Create (or truncate) an export file for odd seeds 1..limit and map it writable. The
+// blocks are reserved up front unless reserve is false; the file is then sparse and
+// blocks are allocated as pages are first written.
+bool collatz_export_create(CollatzExportFile& file, const std::string& path,
+                           uint64_t limit, uint32_t peak_mode, bool reserve = true);
+// Map an existing export file read-only
+bool collatz_export_open(CollatzExportFile& file, const std::string& path);
+void collatz_export_close(CollatzExportFile& file);
+
+// Run the 8-way engine and write every seed's steps (and peak) straight into the file
+int collatz_compute_export(uint64_t limit, CollatzResult& out, int countThread,
+                           const std::string& path, uint32_t peak_mode);
+
+// Export with the file as a memo of every finished seed (peak column COLLATZ_PEAK_LOG16).
+// Seeds above the cache run in doubling phases [x, 2x) whose walks stop as soon as they
+// drop below x, since the rest of the trajectory is already in the file. Walks get
+// shorter but stop on scattered file pages, so past RAM the run is bound by I/O.
+// Seeds 8q+5 are not walked at all (CollatzOptions::derive). The file is left sparse.
+int collatz_compute_descent(uint64_t limit, CollatzResult& out, int countThread, const std::string& path);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int collatz_compute_export_and_write_pipe(int countThread, uint64_t limit, const char* path,
+                                          uint32_t peak_mode, int result_fd, int log_fd);
+int collatz_compute_descent_and_write_pipe(int countThread, uint64_t limit, const char* path,
+                                           int result_fd, int log_fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COLLATZ_EXPORT_H
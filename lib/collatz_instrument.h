@@ -0,0 +1,44 @@
+#ifndef COLLATZ_INSTRUMENT_H
+#define COLLATZ_INSTRUMENT_H
+
+#include <chrono>
+#include "collatz.h"
+
+// COLLATZ_COUNT(counters, field, n) adds n to a CollatzCounters field. Without
+// COLLATZ_INSTRUMENT it only names its arguments inside sizeof, so nothing is
+// evaluated and values kept just for the counters do not warn as unused.
+#ifdef COLLATZ_INSTRUMENT
+#define COLLATZ_COUNT(counters, field, n) ((counters).field += static_cast<uint64_t>(n))
+#else
+#define COLLATZ_COUNT(counters, field, n) ((void)sizeof((counters).field += static_cast<uint64_t>(n)))
+#endif
+
+using CollatzClock = std::chrono::steady_clock;
+
+inline double collatz_seconds_between(CollatzClock::time_point a, CollatzClock::time_point b) {
+    return std::chrono::duration<double>(b - a).count();
+}
+
+// Fold one thread's counters into the run total (join waits are summed and maxed)
+inline void collatz_counters_add(CollatzCounters& total, const CollatzCounters& c) {
+    total.seeds += c.seeds;
+    total.steps_above_cache += c.steps_above_cache;
+    total.cache_lookups += c.cache_lookups;
+    total.slow_path += c.slow_path;
+    total.idle_lanes += c.idle_lanes;
+    total.derived += c.derived;
+    total.join_wait_seconds += c.join_wait_seconds;
+    if (c.max_join_wait_seconds > total.max_join_wait_seconds) {
+        total.max_join_wait_seconds = c.max_join_wait_seconds;
+    }
+}
+
+// Time a thread that returned at finished spent waiting for the join that ended at joined
+inline void collatz_counters_set_join_wait(CollatzCounters& c, CollatzClock::time_point finished,
+                                           CollatzClock::time_point joined) {
+    double wait = finished < joined ? collatz_seconds_between(finished, joined) : 0.0;
+    c.join_wait_seconds = wait;
+    c.max_join_wait_seconds = wait;
+}
+
+#endif // COLLATZ_INSTRUMENT_H
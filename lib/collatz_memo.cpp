@@ -0,0 +1,9 @@
+#include <algorithm>
+#include "collatz_memo.h"
+
+void collatz_memo_reset(CollatzMemo& memo, uint32_t bits) {
+    memo.slots.reset();
+    memo.bits = std::min(bits, COLLATZ_MEMO_MAX_BITS);
+    if (memo.bits == 0) return;
+    memo.slots = std::make_unique<CollatzMemoSlot[]>(size_t(1) << memo.bits);
+}
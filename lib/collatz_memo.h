@@ -0,0 +1,87 @@
+#ifndef COLLATZ_MEMO_H
+#define COLLATZ_MEMO_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+// Values above the cache whose bits 0..COLLATZ_MEMO_CHECKPOINT_BITS are all set are
+// checkpoints: only those are looked up and recorded, so about one odd value in
+// 2^bits touches the table
+constexpr int COLLATZ_MEMO_CHECKPOINT_BITS = 9;
+constexpr uint64_t COLLATZ_MEMO_CHECKPOINT_MASK = (2ULL << COLLATZ_MEMO_CHECKPOINT_BITS) - 1;
+// A key only lives in this many slots from its hash; past them the table counts as full
+constexpr int COLLATZ_MEMO_PROBES = 4;
+constexpr uint32_t COLLATZ_MEMO_MAX_BITS = 30;
+
+// Where the trajectory of a checkpoint value enters the cache
+struct CollatzMemoEntry {
+    uint64_t exit;      // odd cache entry the walk ends on
+    uint32_t steps;     // steps from the checkpoint to exit
+    uint64_t peak;      // highest value from the checkpoint to exit
+};
+
+// A slot is claimed once by a CAS on key and never changes hands. The writer then stores
+// peak and publishes with a release store of packed = (steps << 32) | exit, which is never
+// 0, so a reader that sees packed also sees peak. No locks: a reader that finds a
+// claimed but unpublished slot treats it as a miss.
+struct CollatzMemoSlot {
+    std::atomic<uint64_t> key{0};
+    std::atomic<uint64_t> packed{0};
+    std::atomic<uint64_t> peak{0};
+};
+
+struct CollatzMemo {
+    std::unique_ptr<CollatzMemoSlot[]> slots;
+    uint32_t bits = 0;
+};
+
+// Replace the table with an empty one of 2^bits slots (bits up to COLLATZ_MEMO_MAX_BITS);
+// 0 frees it
+void collatz_memo_reset(CollatzMemo& memo, uint32_t bits);
+
+inline bool collatz_memo_checkpoint(uint64_t n) {
+    return (n & COLLATZ_MEMO_CHECKPOINT_MASK) == COLLATZ_MEMO_CHECKPOINT_MASK;
+}
+
+inline size_t collatz_memo_home(const CollatzMemo& memo, uint64_t key) {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> (64 - memo.bits));
+}
+
+inline bool collatz_memo_find(const CollatzMemo& memo, uint64_t key, CollatzMemoEntry& e) {
+    const size_t mask = (size_t(1) << memo.bits) - 1;
+    size_t i = collatz_memo_home(memo, key);
+    for (int probe = 0; probe < COLLATZ_MEMO_PROBES; ++probe, i = (i + 1) & mask) {
+        const CollatzMemoSlot& slot = memo.slots[i];
+        uint64_t k = slot.key.load(std::memory_order_relaxed);
+        if (k == 0) return false;
+        if (k != key) continue;
+        uint64_t packed = slot.packed.load(std::memory_order_acquire);
+        if (packed == 0) return false;
+        e.exit = packed & 0xFFFFFFFFULL;
+        e.steps = static_cast<uint32_t>(packed >> 32);
+        e.peak = slot.peak.load(std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+// false if the key is already there (or being written) or its probe window is full
+inline bool collatz_memo_insert(CollatzMemo& memo, uint64_t key, const CollatzMemoEntry& e) {
+    const size_t mask = (size_t(1) << memo.bits) - 1;
+    size_t i = collatz_memo_home(memo, key);
+    for (int probe = 0; probe < COLLATZ_MEMO_PROBES; ++probe, i = (i + 1) & mask) {
+        CollatzMemoSlot& slot = memo.slots[i];
+        uint64_t k = slot.key.load(std::memory_order_relaxed);
+        if (k == 0 && slot.key.compare_exchange_strong(k, key, std::memory_order_relaxed)) {
+            slot.peak.store(e.peak, std::memory_order_relaxed);
+            slot.packed.store((static_cast<uint64_t>(e.steps) << 32) | e.exit, std::memory_order_release);
+            return true;
+        }
+        if (k == key) return false;     // k now holds whoever won the slot
+    }
+    return false;
+}
+
+#endif // COLLATZ_MEMO_H
@@ -0,0 +1,123 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include "platform_compat.h"
+#include "collatz_perf.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+static const char* const PERF_EVENT_NAMES[COLLATZ_PERF_EVENTS] = {
+    "cycles", "instructions", "branch_misses", "llc_misses", "dtlb_misses"
+};
+
+// -1 = not decided yet (read COLLATZ_PERF on first use), 0 = off, 1 = on
+static std::atomic<int> g_perf_enabled{-1};
+
+bool collatz_perf_enabled() {
+    int v = g_perf_enabled.load(std::memory_order_relaxed);
+    if (v < 0) {
+        const char* env = std::getenv("COLLATZ_PERF");
+        v = (env && *env && std::strcmp(env, "0") != 0) ? 1 : 0;
+        g_perf_enabled.store(v, std::memory_order_relaxed);
+    }
+    return v == 1;
+}
+
+void collatz_perf_set_enabled(bool enabled) {
+    g_perf_enabled.store(enabled ? 1 : 0, std::memory_order_relaxed);
+}
+
+const char* collatz_perf_event_name(int event) {
+    return (event >= 0 && event < COLLATZ_PERF_EVENTS) ? PERF_EVENT_NAMES[event] : "unknown";
+}
+
+void collatz_perf_add(CollatzPerfCounts& total, const CollatzPerfCounts& part) {
+    if (part.samples == 0) return;
+    total.valid = (total.samples == 0) ? part.valid : (total.valid & part.valid);
+    for (int e = 0; e < COLLATZ_PERF_EVENTS; ++e) total.value[e] += part.value[e];
+    total.samples += part.samples;
+}
+
+// ================= LINUX =================
+#ifdef __linux__
+
+static void perf_attr(int event, perf_event_attr& attr) {
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (event) {
+    case COLLATZ_PERF_CYCLES:        attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+    case COLLATZ_PERF_INSTRUCTIONS:  attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+    case COLLATZ_PERF_BRANCH_MISSES: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+    case COLLATZ_PERF_LLC_MISSES:    attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+    case COLLATZ_PERF_DTLB_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    }
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;    // allowed at the default perf_event_paranoid level
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+}
+
+void collatz_perf_begin(CollatzPerfSession& session, bool inherit) {
+    for (int e = 0; e < COLLATZ_PERF_EVENTS; ++e) session.fd[e] = -1;
+    session.active = collatz_perf_enabled();
+    if (!session.active) return;
+
+    for (int e = 0; e < COLLATZ_PERF_EVENTS; ++e) {
+        perf_event_attr attr;
+        perf_attr(e, attr);
+        attr.inherit = inherit ? 1 : 0;
+        session.fd[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    for (int e = 0; e < COLLATZ_PERF_EVENTS; ++e) {
+        if (session.fd[e] != -1) ioctl(session.fd[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void collatz_perf_end(CollatzPerfSession& session, CollatzPerfCounts& counts) {
+    if (!session.active) return;
+
+    CollatzPerfCounts part{};
+    part.samples = 1;
+    for (int e = 0; e < COLLATZ_PERF_EVENTS; ++e) {
+        if (session.fd[e] != -1) ioctl(session.fd[e], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int e = 0; e < COLLATZ_PERF_EVENTS; ++e) {
+        if (session.fd[e] == -1) continue;
+        uint64_t data[3] = {0, 0, 0}; // value, time enabled, time running
+        if (read(session.fd[e], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)) && data[2] > 0) {
+            part.value[e] = (data[2] < data[1])
+                ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+                : data[0];
+            part.valid |= 1u << e;
+        }
+        close(session.fd[e]);
+        session.fd[e] = -1;
+    }
+    collatz_perf_add(counts, part);
+}
+
+#else
+
+void collatz_perf_begin(CollatzPerfSession& session, bool) {
+    for (int e = 0; e < COLLATZ_PERF_EVENTS; ++e) session.fd[e] = -1;
+    session.active = collatz_perf_enabled();
+}
+
+void collatz_perf_end(CollatzPerfSession& session, CollatzPerfCounts& counts) {
+    if (!session.active) return;
+    CollatzPerfCounts part{};
+    part.samples = 1;
+    collatz_perf_add(counts, part);
+}
+
+#endif
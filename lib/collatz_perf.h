@@ -0,0 +1,29 @@
+#ifndef COLLATZ_PERF_H
+#define COLLATZ_PERF_H
+
+#include <cstdint>
+#include "collatz.h"
+
+// Per-thread hardware counters via perf_event_open (Linux only). Off unless enabled
+// here or with COLLATZ_PERF=1 in the environment. Events that cannot be opened
+// (no PMU in a VM, perf_event_paranoid, seccomp in a container, other OS) are
+// simply left invalid; the run itself is never affected.
+bool collatz_perf_enabled();
+void collatz_perf_set_enabled(bool enabled);
+
+const char* collatz_perf_event_name(int event);
+
+// Counters of the calling thread. With inherit, threads it creates afterwards are
+// counted too (their counts are added once they exit).
+struct CollatzPerfSession {
+    int fd[COLLATZ_PERF_EVENTS];
+    bool active;    // perf was enabled at begin; an inactive session adds nothing
+};
+
+void collatz_perf_begin(CollatzPerfSession& session, bool inherit = false);
+// Stop, read (scaled if the kernel multiplexed the events), close and add into counts
+void collatz_perf_end(CollatzPerfSession& session, CollatzPerfCounts& counts);
+
+void collatz_perf_add(CollatzPerfCounts& total, const CollatzPerfCounts& part);
+
+#endif // COLLATZ_PERF_H
@@ -0,0 +1,66 @@
+#include <condition_variable>
+#include <deque>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include "collatz_pool.h"
+#include "collatz_trace.h"
+
+struct CollatzPool {
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> queue;
+    std::vector<std::thread> threads;
+    bool stopping = false;
+
+    ~CollatzPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    void loop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+static CollatzPool& pool() {
+    static CollatzPool instance;
+    return instance;
+}
+
+void collatz_pool_run(std::vector<std::function<void()>>& tasks) {
+    if (tasks.empty()) return;
+    CollatzPool& p = pool();
+    std::latch done(static_cast<std::ptrdiff_t>(tasks.size()));
+    // Tasks record into the trace session of the run that handed them over
+    CollatzTraceSession* trace = collatz_trace_current();
+    {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        while (p.threads.size() < tasks.size()) p.threads.emplace_back([&p] { p.loop(); });
+        for (auto& task : tasks) {
+            p.queue.emplace_back([&task, &done, trace] {
+                {
+                    CollatzTraceBind bind(trace);
+                    task();
+                }
+                done.count_down();
+            });
+        }
+    }
+    p.wake.notify_all();
+    done.wait();
+}
@@ -0,0 +1,15 @@
+#ifndef COLLATZ_POOL_H
+#define COLLATZ_POOL_H
+
+#include <functional>
+#include <vector>
+
+// Worker threads shared by every run in the process. The pool starts empty and grows to
+// the largest batch it has been handed, so a run alone still gets one thread per task;
+// batches of concurrent runs queue behind each other on the same threads.
+
+// Run every task on the pool and return once all of them have finished. Tasks must not
+// wait on the pool themselves.
+void collatz_pool_run(std::vector<std::function<void()>>& tasks);
+
+#endif // COLLATZ_POOL_H
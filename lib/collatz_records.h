@@ -0,0 +1,68 @@
+#ifndef COLLATZ_RECORDS_H
+#define COLLATZ_RECORDS_H
+
+#include <cstdint>
+#include <algorithm>
+#include "collatz.h"
+
+// Bounded min-heap of the K best (value, seed) records. Better = larger value,
+// ties go to the smaller seed, so the result does not depend on thread split or order.
+// With UniqueValues, each value is kept once (with its smallest seed): many seeds
+// share a peak, and the list should show distinct peaks.
+template<int K, bool UniqueValues>
+struct TopK {
+    CollatzRecord items[K];
+    int count = 0;
+    uint64_t floor = 0; // smallest value that can still enter the list
+
+    // Hot-loop filter; push() settles ties on seed
+    inline bool accepts(uint64_t value) const { return value >= floor; }
+
+    static bool better(const CollatzRecord& a, const CollatzRecord& b) {
+        return a.value != b.value ? a.value > b.value : a.seed < b.seed;
+    }
+
+    void push(uint64_t seed, uint64_t value) {
+        CollatzRecord rec{seed, value};
+        if (UniqueValues) {
+            for (int i = 0; i < count; ++i) {
+                if (items[i].value == value) {
+                    if (seed < items[i].seed) {
+                        items[i].seed = seed;
+                        std::make_heap(items, items + count, better);
+                    }
+                    return;
+                }
+            }
+        }
+        if (count < K) {
+            items[count++] = rec;
+            std::push_heap(items, items + count, better);
+        } else if (better(rec, items[0])) {
+            std::pop_heap(items, items + K, better);
+            items[K - 1] = rec;
+            std::push_heap(items, items + K, better);
+        } else {
+            return;
+        }
+        if (count == K) floor = items[0].value;
+    }
+
+    void merge(const TopK& other) {
+        for (int i = 0; i < other.count; ++i) push(other.items[i].seed, other.items[i].value);
+    }
+
+    // Best first; unused slots are zeroed
+    void sorted(CollatzRecord* out) const {
+        std::copy(items, items + count, out);
+        std::sort(out, out + count, better);
+        std::fill(out + count, out + K, CollatzRecord{0, 0});
+    }
+
+    void clear() { count = 0; floor = 0; }
+};
+
+using LongestRecords = TopK<COLLATZ_TOP_K, false>;
+using PeakRecords = TopK<COLLATZ_TOP_K, true>;
+
+#endif // COLLATZ_RECORDS_H
@@ -6,10 +6,19 @@
 #include <climits>
 #include <algorithm>
 #include <iomanip>
-#include "../../../../Algorithm_windows/CollatzApp_Windows_Fixed/lib/platform_compat.h"
-#include "../../../../Algorithm_windows/CollatzApp_Windows_Fixed/lib/collatz_simd.h"
-
-static std::atomic<int> global_simd__log_fd{-1};
+#include <sstream>
+#include <functional>
+#include "platform_compat.h"
+#include "collatz_simd.h"
+#include "collatz_records.h"
+#include "collatz_instrument.h"
+#include "collatz_perf.h"
+#include "collatz_trace.h"
+#include "collatz_cache.h"
+#include "collatz_export.h"
+#include "collatz_pool.h"
+
+static std::atomic<bool> g_simd_logging_enabled{true};
 
 // --- PLATFORM & SIMD DETECTION ---
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
@@ -37,9 +46,10 @@ inline int ctz64_msvc(uint64_t n) {
 #endif
 
 // ================= HELPER ========================
-// write to log pipe
-static void write_to_log_simd(const std::string& message) {
-    int log_fd = global_simd__log_fd.load(std::memory_order_relaxed);
+// write to the log pipe of a run (-1: console only)
+static void write_to_log_simd(int log_fd, const std::string& message) {
+    if (!g_simd_logging_enabled.load(std::memory_order_relaxed)) return;
+    COLLATZ_TRACE_SCOPE("log flush");
     if (log_fd != -1) {
         write(log_fd, message.c_str(), message.length());
     }
@@ -47,77 +57,181 @@ static void write_to_log_simd(const std::string& message) {
 }
 
 // --- CONFIGURATION ---
-constexpr uint64_t CACHE_LIMIT = 1ULL << 27;
+constexpr uint64_t CACHE_LIMIT = COLLATZ_CACHE_LIMIT;
 // Match SAFE_THRESHOLD from collatz.cpp: (INT64_MAX - 1) / 3
 constexpr uint64_t OVERFLOW_THRESHOLD = 3074457345618258602ULL;
 
-// Global Data
-static std::vector<uint16_t> collatz_cache;
+// Per-worker results of a run, indexed by thread_id
+struct SimdThreadResult {
+    LongestRecords longest;
+    PeakRecords peaks;
+    uint64_t first_overflow = UINT64_MAX;
+    uint64_t histogram[COLLATZ_HIST_SIZE] = {0};
+    CollatzCounters counters{};
+    CollatzPerfCounts perf{};
+    CollatzClock::time_point finished;
+};
+
+// ================= JOB =================
+// Everything one SIMD run writes; runs only share the cache (collatz_cache_acquire)
+// and the worker pool
+struct SimdJob {
+    int log_fd = -1;
+    bool quiet = false;     // no per-worker lines (autotune trials)
+    const CollatzCacheTables* cache = nullptr;
+
+    // Results (merged on the calling thread after the workers are done)
+    uint64_t first_overflow = UINT64_MAX;
+    LongestRecords top_longest;
+    PeakRecords top_peaks;
+
+    // One slot per worker, indexed by thread_id
+    std::vector<SimdThreadResult> thread_results;
+};
+
+// --- STEP HISTOGRAM ---
+// Neighbouring seeds often share a step count, so with one array every increment would
+// wait on the store of the one before it. Seeds rotate over SIMD_HIST_WAYS interleaved
+// 32-bit sub-histograms instead (one bucket's ways share a line but never a counter);
+// they are folded into the 64-bit totals at batch boundaries, well before a counter can
+// wrap, and once more when the worker finishes. The rare step counts past
+// SIMD_HIST_FAST go to the totals directly.
+constexpr int SIMD_HIST_WAYS = 4;
+constexpr uint32_t SIMD_HIST_FAST = 1024;
+constexpr uint64_t SIMD_HIST_FOLD_SEEDS = 1ULL << 31;
+
+struct SimdHistogram {
+    uint32_t sub[SIMD_HIST_FAST][SIMD_HIST_WAYS] = {};
+    uint64_t total[COLLATZ_HIST_SIZE] = {0};
+    uint64_t pending = 0;       // seeds in sub since the last fold
+
+    inline void add(int way, uint64_t steps) {
+        if (steps < SIMD_HIST_FAST) sub[steps][way & (SIMD_HIST_WAYS - 1)]++;
+        else total[std::min<uint64_t>(steps, COLLATZ_HIST_SIZE - 1)]++;
+    }
+    void fold() {
+        for (uint32_t k = 0; k < SIMD_HIST_FAST; ++k) {
+            for (int w = 0; w < SIMD_HIST_WAYS; ++w) total[k] += sub[k][w];
+        }
+        std::fill(&sub[0][0], &sub[0][0] + SIMD_HIST_FAST * SIMD_HIST_WAYS, 0u);
+        pending = 0;
+    }
+};
+static_assert(SIMD_HIST_FAST <= COLLATZ_HIST_SIZE, "sub-histograms must map onto real buckets");
+
+// --- THREAD RESULTS ---
+static void store_thread_result(SimdJob& job, int thread_id, uint64_t start, uint64_t end,
+                                const LongestRecords& longest, const PeakRecords& peaks,
+                                uint64_t first_overflow, SimdHistogram& hist, CollatzPerfSession& perf) {
+    SimdThreadResult& slot = job.thread_results[thread_id];
+    collatz_perf_end(perf, slot.perf);
+    slot.longest = longest;
+    slot.peaks = peaks;
+    slot.first_overflow = first_overflow;
+    hist.fold();
+    std::copy(hist.total, hist.total + COLLATZ_HIST_SIZE, slot.histogram);
+    COLLATZ_COUNT(slot.counters, seeds, end / 2 - start / 2); // odd seeds in [start, end)
+    slot.finished = CollatzClock::now();
+}
 
-// Global Atomics
-std::atomic<uint64_t> g_max_peak(0);
-std::atomic<uint64_t> g_longest_seed(0);
-std::atomic<uint32_t> g_longest_len(0);
-std::atomic<uint64_t> g_first_overflow(UINT64_MAX);
+// --- STAGED CACHE LOOKUPS ---
+// The vector loop only walks lanes down to the cache and parks them here with a
+// prefetch of their cache slot; a full batch is then resolved in one pass, by which
+// time most of those lines have arrived.
+constexpr int SIMD_STAGE_SEEDS = 256;
 
-// --- ATOMIC UPDATES ---
-void atomic_update_max_peak(uint64_t val) {
-    uint64_t prev = g_max_peak.load(std::memory_order_relaxed);
-    while (prev < val && !g_max_peak.compare_exchange_weak(prev, val, std::memory_order_relaxed));
+#if defined(_MSC_VER)
+#define SIMD_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#else
+#define SIMD_PREFETCH(addr) __builtin_prefetch(addr)
+#endif
+
+struct SimdStage {
+    uint64_t n[SIMD_STAGE_SEEDS];
+    uint64_t s[SIMD_STAGE_SEEDS];
+    uint64_t seed[SIMD_STAGE_SEEDS];
+    uint64_t p[SIMD_STAGE_SEEDS];
+    uint64_t tail[SIMD_STAGE_SEEDS];    // odd value the walk entered the cache on, for the peak
+    int count = 0;
+};
+
+// tail is n unless the lane walked on inside the cache (see walk_lanes32); a seed that
+// started below the cache enters it on itself
+static inline void stage_lane(SimdStage& st, const CollatzCacheTables& tables,
+                              uint64_t n, uint64_t s, uint64_t seed, uint64_t p, uint64_t tail) {
+    if (p == seed) tail = seed;
+    tail >>= CTZ(tail);
+    SIMD_PREFETCH(tables.steps.data() + n);
+    SIMD_PREFETCH(tables.peaks.data() + (tail >> 1));
+    st.n[st.count] = n;
+    st.s[st.count] = s;
+    st.seed[st.count] = seed;
+    st.p[st.count] = p;
+    st.tail[st.count] = tail;
+    st.count++;
 }
 
-void atomic_update_longest(uint32_t len, uint64_t seed) {
-    uint32_t prev = g_longest_len.load(std::memory_order_relaxed);
-    while (prev < len) {
-        if (g_longest_len.compare_exchange_weak(prev, len, std::memory_order_relaxed)) {
-            g_longest_seed.store(seed, std::memory_order_relaxed);
-            break;
-        }
-    }
+// Peaks follow the hybrid kernel: the largest 3n+1 on the trajectory. Walks keep p, the
+// largest value they saw above the cache, which is a (3n+1)/2 unless the odd seed started
+// below the cache and p is still the seed. The rest of the trajectory, from the odd
+// tail it entered the cache on, comes from the cache's peak table. The cache-wide bound,
+// then the entry's own bound, filter before the exact peak, as in the hybrid kernel.
+static inline void push_peak(PeakRecords& peaks, const CollatzCacheTables& tables,
+                             uint64_t seed, uint64_t p, uint64_t tail) {
+    uint64_t m = p == seed ? seed : 2 * p;
+    if (!peaks.accepts(std::max(m, tables.peak_max))) return;
+    if (!peaks.accepts(std::max(m, collatz_peak_log16_upper(tables.peaks[tail >> 1])))) return;
+    m = collatz_cache_peak(tables, tail, m);
+    if (peaks.accepts(m)) peaks.push(seed, m);
 }
 
-void atomic_update_overflow(uint64_t seed) {
-    uint64_t prev = g_first_overflow.load(std::memory_order_relaxed);
-    while (prev > seed && !g_first_overflow.compare_exchange_weak(prev, seed, std::memory_order_relaxed));
+static void gather_stage(SimdStage& st, const CollatzCacheTables& tables, LongestRecords& longest,
+                         PeakRecords& peaks, SimdHistogram& hist) {
+    const uint16_t* cache = tables.steps.data();
+    for (int j = 0; j < st.count; ++j) {
+        uint64_t n = st.n[j];
+        uint64_t steps = st.s[j] + cache[n];
+        hist.add(j, steps);
+        if (longest.accepts(steps)) longest.push(st.seed[j], steps);
+        push_peak(peaks, tables, st.seed[j], st.p[j], st.tail[j]);
+    }
+    hist.pending += st.count;
+    if (hist.pending >= SIMD_HIST_FOLD_SEEDS) hist.fold();
+    st.count = 0;
 }
 
-// --- BUILD CACHE ---
-void build_cache() {
-
-    write_to_log_simd("  > Building Cache simd ... ");
-    auto start = std::chrono::high_resolution_clock::now();
-
-    collatz_cache.resize(CACHE_LIMIT);
-    collatz_cache[1] = 0;
-
-    for (uint64_t i = 2; i < CACHE_LIMIT; ++i) {
-        uint64_t n = i;
-        uint16_t steps = 0;
-        while (n >= i) {
-            if ((n & 1) == 0) {
-                n >>= 1;
-                steps++;
-            } else {
-                n = (n * 3 + 1) >> 1;
-                steps += 2;
-            }
+// One seed on the 64-bit scalar path: the tail of a range, and lanes a vector kernel
+// gave up on
+static inline void run_seed_scalar(uint64_t seed, const CollatzCacheTables& tables, LongestRecords& longest,
+                                   PeakRecords& peaks, SimdHistogram& hist, uint64_t& first_overflow) {
+    uint64_t n = seed; uint64_t peak = n; uint32_t steps = 0;
+    while (n >= CACHE_LIMIT) {
+        if (n > peak) peak = n;
+        if ((n & 1) == 0) { int z = CTZ(n); n >>= z; steps += z; }
+        else {
+            if (n > OVERFLOW_THRESHOLD) { if (first_overflow > seed) first_overflow = seed; return; }
+            n = (n * 3 + 1) >> 1; steps += 2;
         }
-        collatz_cache[i] = steps + collatz_cache[n];
     }
-    auto end = std::chrono::high_resolution_clock::now();
-    std::ostringstream oss;
-    oss << "Done (" << std::chrono::duration<double>(end - start).count() << "s)\n";
-    write_to_log_simd(oss.str());
+    steps += tables.steps[n];
+    hist.total[std::min<uint64_t>(steps, COLLATZ_HIST_SIZE - 1)]++;
+    if (longest.accepts(steps)) longest.push(seed, steps);
+    push_peak(peaks, tables, seed, peak, peak == seed ? seed : n >> CTZ(n));
 }
 
 // --- WORKER ARM ROUTINE ---
 #ifdef IS_ARM
-void worker_simd(uint64_t start, uint64_t end, int thread_id) {
-    uint64_t local_max_peak = 0;
-    uint32_t local_longest_len = 0;
-    uint64_t local_longest_seed = 0;
+static void worker_simd(SimdJob& job, uint64_t start, uint64_t end, int thread_id) {
+    LongestRecords local_longest;
+    PeakRecords local_peaks;
     uint64_t local_first_overflow = UINT64_MAX;
-    const uint16_t* cache = collatz_cache.data();
+    const CollatzCacheTables& tables = *job.cache;
+    SimdStage stage;
+    SimdHistogram local_hist;
+    if (collatz_trace_on()) collatz_trace_thread_name("simd worker " + std::to_string(thread_id));
+    CollatzTraceScope span("simd worker", start);
+    CollatzPerfSession perf;
+    collatz_perf_begin(perf);
 
     const uint64x2_t v_limit = vdupq_n_u64(CACHE_LIMIT);
     const uint64x2_t v_one   = vdupq_n_u64(1);
@@ -183,29 +297,9 @@ void worker_simd(uint64_t start, uint64_t end, int thread_id) {
             STEP_NEON(v6, s6, m6, p6); STEP_NEON(v7, s7, m7, p7);
         }
 
-        auto finalize = [&](uint64x2_t val, uint64x2_t st, uint64x2_t sd, uint64x2_t pk) {
-            uint64_t v[2], s[2], d[2], p[2];
-            vst1q_u64(v, val); vst1q_u64(s, st); vst1q_u64(d, sd); vst1q_u64(p, pk);
-            for(int k=0; k<2; k++) {
-                uint64_t n = v[k];
-                while (n >= CACHE_LIMIT) {
-                    if (n > p[k]) p[k] = n;
-                    if (n & 1) { n = (n * 3 + 1) >> 1; s[k] += 2; }
-                    else { n >>= 1; s[k]++; }
-                }
-                s[k] += cache[n];
-                if (s[k] > local_longest_len) { local_longest_len = s[k]; local_longest_seed = d[k]; }
-                if (p[k] > local_max_peak) local_max_peak = p[k];
-            }
-        };
-
-        finalize(v0, s0, sd0, p0); finalize(v1, s1, sd1, p1);
-        finalize(v2, s2, sd2, p2); finalize(v3, s3, sd3, p3);
-        finalize(v4, s4, sd4, p4); finalize(v5, s5, sd5, p5);
-        finalize(v6, s6, sd6, p6); finalize(v7, s7, sd7, p7);
-
+        // ovf is shared by all vectors: re-check seeds scalar-wise to find exact overflow
+        bool lane_ovf[16] = {};
         if ((vgetq_lane_u64(ovf, 0) | vgetq_lane_u64(ovf, 1)) != 0) {
-            // Re-check seeds scalar-wise to find exact overflow
             for(int k=0; k<16; k++) {
                 uint64_t n = seeds[k];
                 while (n >= CACHE_LIMIT) {
@@ -213,6 +307,7 @@ void worker_simd(uint64_t start, uint64_t end, int thread_id) {
                         n >>= 1;
                     } else {
                         if (n > OVERFLOW_THRESHOLD) {
+                            lane_ovf[k] = true;
                             if (seeds[k] < local_first_overflow) local_first_overflow = seeds[k];
                             break;
                         }
@@ -221,44 +316,58 @@ void worker_simd(uint64_t start, uint64_t end, int thread_id) {
                 }
             }
         }
+
+        // Finalize; overflowed lanes were recorded above and are left out
+        auto finalize = [&](int base, uint64x2_t val, uint64x2_t st, uint64x2_t sd, uint64x2_t pk) {
+            uint64_t v[2], s[2], d[2], p[2];
+            vst1q_u64(v, val); vst1q_u64(s, st); vst1q_u64(d, sd); vst1q_u64(p, pk);
+            for(int k=0; k<2; k++) {
+                if (lane_ovf[base + k]) continue;
+                uint64_t n = v[k];
+                while (n >= CACHE_LIMIT) {
+                    if (n > p[k]) p[k] = n;
+                    if (n & 1) { n = (n * 3 + 1) >> 1; s[k] += 2; }
+                    else { n >>= 1; s[k]++; }
+                }
+                stage_lane(stage, tables, n, s[k], d[k], p[k], n);
+            }
+        };
+
+        finalize(0, v0, s0, sd0, p0); finalize(2, v1, s1, sd1, p1);
+        finalize(4, v2, s2, sd2, p2); finalize(6, v3, s3, sd3, p3);
+        finalize(8, v4, s4, sd4, p4); finalize(10, v5, s5, sd5, p5);
+        finalize(12, v6, s6, sd6, p6); finalize(14, v7, s7, sd7, p7);
+        // Dropped lanes are not staged, so the batch does not fill in whole blocks
+        if (stage.count > SIMD_STAGE_SEEDS - 16) gather_stage(stage, tables, local_longest, local_peaks, local_hist);
     }
+    gather_stage(stage, tables, local_longest, local_peaks, local_hist);
 
     // Scalar Cleanup
     for (; i < end; i += 2) {
-        uint64_t n = i; uint64_t peak = n; uint32_t steps = 0; bool overflowed = false;
-        while (n >= CACHE_LIMIT) {
-            if (n > peak) peak = n;
-            if ((n & 1) == 0) { int z = CTZ(n); n >>= z; steps += z; }
-            else {
-                if (n > OVERFLOW_THRESHOLD) { if (local_first_overflow > i) local_first_overflow = i; overflowed = true; break; }
-                n = (n * 3 + 1) >> 1; steps += 2;
-            }
-        }
-        if (!overflowed) {
-            steps += cache[n];
-            if (steps > local_longest_len) { local_longest_len = steps; local_longest_seed = i; }
-            if (peak > local_max_peak) local_max_peak = peak;
-        }
+        run_seed_scalar(i, tables, local_longest, local_peaks, local_hist, local_first_overflow);
     }
-    atomic_update_max_peak(local_max_peak);
-    atomic_update_longest(local_longest_len, local_longest_seed);
-    atomic_update_overflow(local_first_overflow);
+    store_thread_result(job, thread_id, start, end, local_longest, local_peaks, local_first_overflow, local_hist, perf);
 
     std::ostringstream oss;
     oss << "  ✓ Worker simd " << thread_id << " finished.\n";
-    write_to_log_simd(oss.str());
+    if (!job.quiet) write_to_log_simd(job.log_fd, oss.str());
 
 }
 #endif
 
 // --- WORKER WINDOWS / LINUX x86 ---
 #ifdef IS_X86
-void worker_simd(uint64_t start, uint64_t end, int thread_id ) {
-    uint64_t local_max_peak = 0;
-    uint32_t local_longest_len = 0;
-    uint64_t local_longest_seed = 0;
+static void worker_simd(SimdJob& job, uint64_t start, uint64_t end, int thread_id) {
+    LongestRecords local_longest;
+    PeakRecords local_peaks;
     uint64_t local_first_overflow = UINT64_MAX;
-    const uint16_t* cache = collatz_cache.data();
+    const CollatzCacheTables& tables = *job.cache;
+    SimdStage stage;
+    SimdHistogram local_hist;
+    if (collatz_trace_on()) collatz_trace_thread_name("simd worker " + std::to_string(thread_id));
+    CollatzTraceScope span("simd worker", start);
+    CollatzPerfSession perf;
+    collatz_perf_begin(perf);
 
     // AVX2 Constants
     const __m256i v_limit  = _mm256_set1_epi64x(CACHE_LIMIT);
@@ -358,64 +467,381 @@ void worker_simd(uint64_t start, uint64_t end, int thread_id ) {
             }
         }
 
-        // Finalize
-        auto finalize = [&](__m256i val, __m256i st, __m256i sd, __m256i pk) {
-            uint64_t v[4], s[4], d[4], p[4];
+        // Finalize; overflowed lanes were recorded above and are left out
+        auto finalize = [&](__m256i val, __m256i st, __m256i sd, __m256i pk, __m256i of) {
+            uint64_t v[4], s[4], d[4], p[4], o[4];
             _mm256_storeu_si256((__m256i*)v, val); _mm256_storeu_si256((__m256i*)s, st);
             _mm256_storeu_si256((__m256i*)d, sd);  _mm256_storeu_si256((__m256i*)p, pk);
+            _mm256_storeu_si256((__m256i*)o, of);
 
             for(int k=0; k<4; k++) {
+                if (o[k]) continue;
                 uint64_t n = v[k];
                 while (n >= CACHE_LIMIT) {
                     if (n > p[k]) p[k] = n;
                     if (n & 1) { n = (n * 3 + 1) >> 1; s[k] += 2; }
                     else { n >>= 1; s[k]++; }
                 }
-                s[k] += cache[n];
-                if (s[k] > local_longest_len) { local_longest_len = s[k]; local_longest_seed = d[k]; }
-                if (p[k] > local_max_peak) local_max_peak = p[k];
+                stage_lane(stage, tables, n, s[k], d[k], p[k], n);
             }
         };
 
-        finalize(v0, s0, sd0, p0); finalize(v1, s1, sd1, p1);
-        finalize(v2, s2, sd2, p2); finalize(v3, s3, sd3, p3);
+        finalize(v0, s0, sd0, p0, ovf0); finalize(v1, s1, sd1, p1, ovf1);
+        finalize(v2, s2, sd2, p2, ovf2); finalize(v3, s3, sd3, p3, ovf3);
+        // Dropped lanes are not staged, so the batch does not fill in whole blocks
+        if (stage.count > SIMD_STAGE_SEEDS - 16) gather_stage(stage, tables, local_longest, local_peaks, local_hist);
     }
+    gather_stage(stage, tables, local_longest, local_peaks, local_hist);
 
     // Scalar Cleanup
     for (; i < end; i += 2) {
-        uint64_t n = i; uint64_t peak = n; uint32_t steps = 0; bool overflowed = false;
-        while (n >= CACHE_LIMIT) {
-            if (n > peak) peak = n;
-            if ((n & 1) == 0) { int z = CTZ(n); n >>= z; steps += z; }
-            else {
-                if (n > OVERFLOW_THRESHOLD) { if (local_first_overflow > i) local_first_overflow = i; overflowed = true; break; }
-                n = (n * 3 + 1) >> 1; steps += 2;
+        run_seed_scalar(i, tables, local_longest, local_peaks, local_hist, local_first_overflow);
+    }
+    store_thread_result(job, thread_id, start, end, local_longest, local_peaks, local_first_overflow, local_hist, perf);
+    std::ostringstream oss;
+    oss << "  ✓ Worker_simd " << thread_id << " finished.\n";
+    if (!job.quiet) write_to_log_simd(job.log_fd, oss.str());
+}
+#endif
+
+// --- WORKER x86, 32-BIT LANES ---
+// Below 2^32, trajectories nearly always reach the cache before they leave 32 bits, so
+// lanes can be half as wide: 8 per AVX2 register, 16 with AVX-512. A lane whose next
+// odd step would pass 32 bits is dropped and its seed rerun on the 64-bit scalar path.
+#ifdef IS_X86
+constexpr uint64_t SIMD32_SEED_LIMIT = 1ULL << 32;     // range end (exclusive) for 32-bit lanes
+constexpr uint32_t SIMD32_ODD_MAX = 0xAAAAAAA9u;       // largest odd n with (3n+1)/2 < 2^32
+constexpr int SIMD32_VECTORS = 4;                      // interleaved registers per block
+
+#if defined(__AVX512F__)
+constexpr int SIMD32_WIDTH = 16;
+#else
+constexpr int SIMD32_WIDTH = 8;
+#endif
+constexpr int SIMD32_BLOCK = SIMD32_VECTORS * SIMD32_WIDTH;
+
+// Seeds n = a * 2^K + b with the same b take the same parity path for their first K
+// steps, so tiles of the range are walked residue class by residue class (b outer, a
+// inner) and a block whose lanes share b runs those steps without per-lane parity or blends.
+constexpr int RESIDUE_BITS = 10;
+constexpr uint64_t RESIDUE_STRIDE = 1ULL << RESIDUE_BITS;
+
+// Parity path of one residue class: bit j set if step j is odd
+struct ResiduePrefix {
+    uint32_t odd_bits;
+    uint32_t steps;     // shortcut steps of the prefix: RESIDUE_BITS + number of odd steps
+};
+
+static ResiduePrefix residue_prefix(uint64_t b) {
+    ResiduePrefix r{0, 0};
+    for (int j = 0; j < RESIDUE_BITS; ++j) {
+        if (b & 1) { r.odd_bits |= 1u << j; b = b + (b >> 1) + 1; r.steps += 2; }
+        else { b >>= 1; r.steps += 1; }
+    }
+    return r;
+}
+
+// Walks the lanes of v down to CACHE_LIMIT; s gets their (3n+1)/2-shortcut steps, p
+// their peak and o is set for lanes that were dropped. With a prefix, all lanes share
+// its residue class and take its first RESIDUE_BITS steps unconditionally: a lane that
+// dips to the cache in there keeps walking (its step count stays exact) but no longer
+// raises its peak, and t gets the value it dipped to, where the sequential walk would
+// have stopped (0 for lanes that did not dip).
+static inline void walk_lanes32(uint32_t* v, uint32_t* s, uint32_t* p, uint32_t* o, uint32_t* t,
+                                const ResiduePrefix* prefix) {
+#if defined(__AVX512F__)
+    const __m512i v_limit = _mm512_set1_epi32(static_cast<int>(CACHE_LIMIT));
+    const __m512i v_odd_max = _mm512_set1_epi32(static_cast<int>(SIMD32_ODD_MAX));
+    const __m512i v_one = _mm512_set1_epi32(1);
+    const __m512i v_two = _mm512_set1_epi32(2);
+
+    __m512i V[SIMD32_VECTORS], S[SIMD32_VECTORS], P[SIMD32_VECTORS], T[SIMD32_VECTORS];
+    __mmask16 M[SIMD32_VECTORS], O[SIMD32_VECTORS], A[SIMD32_VECTORS];
+    for (int q = 0; q < SIMD32_VECTORS; ++q) {
+        V[q] = _mm512_loadu_si512(v + q * SIMD32_WIDTH);
+        S[q] = _mm512_setzero_si512();
+        P[q] = V[q];
+        T[q] = _mm512_setzero_si512();
+        O[q] = 0;
+        A[q] = 0xFFFF;  // lanes that may still raise their peak
+    }
+
+    if (prefix) {
+        for (int j = 0; j < RESIDUE_BITS; ++j) {
+            bool odd = (prefix->odd_bits >> j) & 1;
+            for (int q = 0; q < SIMD32_VECTORS; ++q) {
+                __mmask16 above = _mm512_cmpgt_epu32_mask(V[q], v_limit);
+                T[q] = _mm512_mask_mov_epi32(T[q], A[q] & ~above, V[q]);
+                A[q] &= above;
+                P[q] = _mm512_mask_max_epu32(P[q], A[q], P[q], V[q]);
+                __m512i half = _mm512_srli_epi32(V[q], 1);
+                if (odd) {
+                    O[q] |= _mm512_cmpgt_epu32_mask(V[q], v_odd_max);
+                    V[q] = _mm512_add_epi32(_mm512_add_epi32(V[q], half), v_one);
+                } else {
+                    V[q] = half;
+                }
             }
         }
-        if (!overflowed) {
-            steps += cache[n];
-            if (steps > local_longest_len) { local_longest_len = steps; local_longest_seed = i; }
-            if (peak > local_max_peak) local_max_peak = peak;
+        for (int q = 0; q < SIMD32_VECTORS; ++q) S[q] = _mm512_set1_epi32(static_cast<int>(prefix->steps));
+    }
+    for (int q = 0; q < SIMD32_VECTORS; ++q) M[q] = _mm512_cmpgt_epu32_mask(V[q], v_limit) & ~O[q];
+
+    while ((M[0] | M[1] | M[2] | M[3]) != 0) {
+        for (int q = 0; q < SIMD32_VECTORS; ++q) {
+            // Settled lanes sit at or below the limit, so they never raise their peak
+            P[q] = _mm512_mask_max_epu32(P[q], A[q], P[q], V[q]);
+            __mmask16 odd = _mm512_test_epi32_mask(V[q], v_one);
+            __mmask16 ovf = odd & M[q] & _mm512_cmpgt_epu32_mask(V[q], v_odd_max);
+            O[q] |= ovf;
+            __mmask16 m = M[q] & ~ovf;
+
+            __m512i half = _mm512_srli_epi32(V[q], 1);
+            __m512i next = _mm512_mask_add_epi32(half, odd, _mm512_add_epi32(V[q], half), v_one);
+            V[q] = _mm512_mask_mov_epi32(V[q], m, next);
+            S[q] = _mm512_mask_add_epi32(S[q], m, S[q], _mm512_mask_blend_epi32(odd, v_one, v_two));
+            M[q] = _mm512_cmpgt_epu32_mask(V[q], v_limit) & ~O[q];
+        }
+    }
+
+    for (int q = 0; q < SIMD32_VECTORS; ++q) {
+        _mm512_storeu_si512(v + q * SIMD32_WIDTH, V[q]);
+        _mm512_storeu_si512(s + q * SIMD32_WIDTH, S[q]);
+        _mm512_storeu_si512(p + q * SIMD32_WIDTH, P[q]);
+        _mm512_storeu_si512(t + q * SIMD32_WIDTH, T[q]);
+        _mm512_storeu_si512(o + q * SIMD32_WIDTH, _mm512_maskz_mov_epi32(O[q], v_one));
+    }
+#else
+    // AVX2 has no unsigned 32-bit compare: flip the sign bit and compare signed
+    const __m256i v_flip = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    const __m256i v_limit = _mm256_set1_epi32(static_cast<int>(CACHE_LIMIT ^ 0x80000000u));
+    const __m256i v_odd_max = _mm256_set1_epi32(static_cast<int>(SIMD32_ODD_MAX ^ 0x80000000u));
+    const __m256i v_one = _mm256_set1_epi32(1);
+    const __m256i v_two = _mm256_set1_epi32(2);
+
+    __m256i V[SIMD32_VECTORS], S[SIMD32_VECTORS], P[SIMD32_VECTORS], M[SIMD32_VECTORS], O[SIMD32_VECTORS];
+    __m256i A[SIMD32_VECTORS], T[SIMD32_VECTORS];
+    for (int q = 0; q < SIMD32_VECTORS; ++q) {
+        V[q] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + q * SIMD32_WIDTH));
+        S[q] = _mm256_setzero_si256();
+        P[q] = V[q];
+        T[q] = _mm256_setzero_si256();
+        O[q] = _mm256_setzero_si256();
+        A[q] = _mm256_set1_epi32(-1);   // lanes that may still raise their peak
+    }
+
+    if (prefix) {
+        for (int j = 0; j < RESIDUE_BITS; ++j) {
+            bool odd = (prefix->odd_bits >> j) & 1;
+            for (int q = 0; q < SIMD32_VECTORS; ++q) {
+                __m256i above = _mm256_cmpgt_epi32(_mm256_xor_si256(V[q], v_flip), v_limit);
+                T[q] = _mm256_blendv_epi8(T[q], V[q], _mm256_andnot_si256(above, A[q]));
+                A[q] = _mm256_and_si256(A[q], above);
+                P[q] = _mm256_max_epu32(P[q], _mm256_and_si256(V[q], A[q]));
+                __m256i half = _mm256_srli_epi32(V[q], 1);
+                if (odd) {
+                    O[q] = _mm256_or_si256(O[q], _mm256_cmpgt_epi32(_mm256_xor_si256(V[q], v_flip), v_odd_max));
+                    V[q] = _mm256_add_epi32(_mm256_add_epi32(V[q], half), v_one);
+                } else {
+                    V[q] = half;
+                }
+            }
+        }
+        for (int q = 0; q < SIMD32_VECTORS; ++q) S[q] = _mm256_set1_epi32(static_cast<int>(prefix->steps));
+    }
+    for (int q = 0; q < SIMD32_VECTORS; ++q) {
+        M[q] = _mm256_andnot_si256(O[q], _mm256_cmpgt_epi32(_mm256_xor_si256(V[q], v_flip), v_limit));
+    }
+
+    for (;;) {
+        __m256i any = _mm256_or_si256(_mm256_or_si256(M[0], M[1]), _mm256_or_si256(M[2], M[3]));
+        if (_mm256_testz_si256(any, any)) break;
+
+        for (int q = 0; q < SIMD32_VECTORS; ++q) {
+            // Settled lanes sit at or below the limit, so they never raise their peak
+            P[q] = _mm256_max_epu32(P[q], _mm256_and_si256(V[q], A[q]));
+            __m256i odd = _mm256_srai_epi32(_mm256_slli_epi32(V[q], 31), 31);
+            __m256i ovf = _mm256_and_si256(_mm256_and_si256(odd, M[q]),
+                                           _mm256_cmpgt_epi32(_mm256_xor_si256(V[q], v_flip), v_odd_max));
+            O[q] = _mm256_or_si256(O[q], ovf);
+            __m256i m = _mm256_andnot_si256(ovf, M[q]);
+
+            __m256i half = _mm256_srli_epi32(V[q], 1);
+            __m256i v_odd = _mm256_add_epi32(_mm256_add_epi32(V[q], half), v_one);
+            __m256i next = _mm256_blendv_epi8(half, v_odd, odd);
+            __m256i inc = _mm256_blendv_epi8(v_one, v_two, odd);
+            V[q] = _mm256_blendv_epi8(V[q], next, m);
+            S[q] = _mm256_add_epi32(S[q], _mm256_and_si256(inc, m));
+            M[q] = _mm256_andnot_si256(O[q], _mm256_cmpgt_epi32(_mm256_xor_si256(V[q], v_flip), v_limit));
         }
     }
-    atomic_update_max_peak(local_max_peak);
-    atomic_update_longest(local_longest_len, local_longest_seed);
-    atomic_update_overflow(local_first_overflow);
+
+    for (int q = 0; q < SIMD32_VECTORS; ++q) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + q * SIMD32_WIDTH), V[q]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s + q * SIMD32_WIDTH), S[q]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + q * SIMD32_WIDTH), P[q]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(t + q * SIMD32_WIDTH), T[q]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + q * SIMD32_WIDTH), O[q]);
+    }
+#endif
+}
+
+static void worker_simd32(SimdJob& job, uint64_t start, uint64_t end, int thread_id) {
+    LongestRecords local_longest;
+    PeakRecords local_peaks;
+    uint64_t local_first_overflow = UINT64_MAX;
+    const CollatzCacheTables& tables = *job.cache;
+    SimdStage stage;
+    SimdHistogram local_hist;
+    if (collatz_trace_on()) collatz_trace_thread_name("simd worker " + std::to_string(thread_id));
+    CollatzTraceScope span("simd worker", start);
+    CollatzPerfSession perf;
+    collatz_perf_begin(perf);
+
+    alignas(64) uint32_t v[SIMD32_BLOCK], s[SIMD32_BLOCK], p[SIMD32_BLOCK], o[SIMD32_BLOCK], t[SIMD32_BLOCK];
+    uint64_t seeds[SIMD32_BLOCK];
+    int filled = 0;
+    bool uniform = true;    // every lane so far is in the residue class of seeds[0]
+
+    auto run_block = [&]() {
+        for (int k = 0; k < SIMD32_BLOCK; ++k) v[k] = static_cast<uint32_t>(seeds[k]);
+
+        // Lanes must stay above 1 through the prefix (seeds within a block ascend)
+        ResiduePrefix prefix{};
+        bool use_prefix = uniform && seeds[0] >= 2 * RESIDUE_STRIDE;
+        if (use_prefix) prefix = residue_prefix(seeds[0] & (RESIDUE_STRIDE - 1));
+        walk_lanes32(v, s, p, o, t, use_prefix ? &prefix : nullptr);
+
+        for (int k = 0; k < SIMD32_BLOCK; ++k) {
+            if (o[k]) {
+                run_seed_scalar(seeds[k], tables, local_longest, local_peaks, local_hist, local_first_overflow);
+                continue;
+            }
+            uint64_t n = v[k];
+            uint64_t steps = s[k];
+            if (n == CACHE_LIMIT) { n >>= 1; steps++; } // the walk stops at n <= CACHE_LIMIT
+            stage_lane(stage, tables, n, steps, seeds[k], p[k], t[k] ? t[k] : n);
+        }
+        // Dropped lanes are not staged, so the batch does not fill in whole blocks
+        if (stage.count > SIMD_STAGE_SEEDS - SIMD32_BLOCK) {
+            gather_stage(stage, tables, local_longest, local_peaks, local_hist);
+        }
+        filled = 0;
+        uniform = true;
+    };
+    auto push = [&](uint64_t seed) {
+        if (filled != 0 && ((seed ^ seeds[0]) & (RESIDUE_STRIDE - 1)) != 0) uniform = false;
+        seeds[filled++] = seed;
+        if (filled == SIMD32_BLOCK) run_block();
+    };
+
+    // Whole tiles of RESIDUE_STRIDE * SIMD32_BLOCK seeds run residue-major (b outer,
+    // a inner), one uniform block per odd residue. Tiles keep the final cache indices
+    // of a stretch of blocks close together; the ragged head and tail run in plain
+    // order. Records do not depend on the order seeds are visited in.
+    constexpr uint64_t TILE = RESIDUE_STRIDE * SIMD32_BLOCK;
+    uint64_t tile_first = (start + TILE - 1) / TILE * TILE;
+    uint64_t tile_end = std::max(tile_first, end / TILE * TILE);
+
+    uint64_t i = start | 1;
+    for (; i < std::min(tile_first, end); i += 2) push(i);
+    for (uint64_t t = tile_first; t < tile_end; t += TILE) {
+        for (uint64_t b = 1; b < RESIDUE_STRIDE; b += 2) {
+            for (uint64_t n = t + b; n < t + TILE; n += RESIDUE_STRIDE) push(n);
+        }
+    }
+    for (i = std::max(i, tile_end | 1); i < end; i += 2) push(i);
+    gather_stage(stage, tables, local_longest, local_peaks, local_hist);
+
+    // Scalar Cleanup
+    for (int k = 0; k < filled; ++k) {
+        run_seed_scalar(seeds[k], tables, local_longest, local_peaks, local_hist, local_first_overflow);
+    }
+    store_thread_result(job, thread_id, start, end, local_longest, local_peaks, local_first_overflow, local_hist, perf);
     std::ostringstream oss;
-    oss << "  ✓ Worker_simd " << thread_id << " finished.\n";
-    write_to_log(oss.str());
+    oss << "  ✓ Worker_simd32 " << thread_id << " finished.\n";
+    if (!job.quiet) write_to_log_simd(job.log_fd, oss.str());
 }
 #endif
 
 // --- MAIN ---
-int collatz_compute_simd(uint64_t limit, CollatzResult& out, int countThread) {
-    // Reset global atomics
-    g_first_overflow.store(UINT64_MAX, std::memory_order_relaxed);
-    g_max_peak.store(0, std::memory_order_relaxed);
-    g_longest_seed.store(1, std::memory_order_relaxed);
-    g_longest_len.store(0, std::memory_order_relaxed);
+// Seeds [first, end) split over the worker threads; fills timing and records into out
+static void run_simd(SimdJob& job, uint64_t first, uint64_t end, CollatzResult& out, int countThread) {
+    unsigned int num_threads = (countThread > 0) ? countThread : std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 4;
 
-    build_cache();
+    std::vector<std::function<void()>> tasks;
+    uint64_t chunk = (end - first) / num_threads;
+
+    job.thread_results.clear();
+    job.thread_results.resize(num_threads);
+
+    auto start_time = CollatzClock::now();
+
+    auto worker = worker_simd;
+#ifdef IS_X86
+    if (end <= SIMD32_SEED_LIMIT) worker = worker_simd32;
+#endif
+
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        uint64_t s = first + i * chunk;
+        uint64_t e = (i == num_threads - 1) ? end : s + chunk;
+        tasks.emplace_back([worker, &job, s, e, i] { worker(job, s, e, static_cast<int>(i)); });
+    }
+    collatz_pool_run(tasks);
+
+    auto joined = CollatzClock::now();
+
+    CollatzPerfSession perf;
+    collatz_perf_begin(perf);
+    {
+        COLLATZ_TRACE_SCOPE("merge phase");
+        for (auto& slot : job.thread_results) {
+            job.top_longest.merge(slot.longest);
+            job.top_peaks.merge(slot.peaks);
+            for (size_t k = 0; k < COLLATZ_HIST_SIZE; ++k) out.histogram[k] += slot.histogram[k];
+            job.first_overflow = std::min(job.first_overflow, slot.first_overflow);
+            collatz_counters_set_join_wait(slot.counters, slot.finished, joined);
+            collatz_counters_add(out.counters, slot.counters);
+            collatz_perf_add(out.perf_compute, slot.perf);
+        }
+        // Seed 1 (0 steps) is walked here but not by the hybrid kernel, which starts at
+        // seed 3; leave it out so both kernels report the same histogram
+        if (first <= 1 && end > 1) out.histogram[0]--;
+    }
+    collatz_perf_end(perf, out.perf_merge);
+    auto merged = CollatzClock::now();
+
+    out.compute_seconds = collatz_seconds_between(start_time, joined);
+    out.merge_seconds = collatz_seconds_between(joined, merged);
+    out.seconds = out.cache_build_seconds + out.compute_seconds + out.merge_seconds;
+    out.throughput = out.seconds > 0 ? ((end - first) / out.seconds / 1e9) : 0.0;
+    out.first_overflow = job.first_overflow == UINT64_MAX ? 0 : job.first_overflow;
+    job.top_longest.sorted(out.top_longest);
+    job.top_peaks.sorted(out.top_peaks);
+    out.longest_len = static_cast<uint32_t>(out.top_longest[0].value);
+    out.longest_seed = job.top_longest.count ? out.top_longest[0].seed : 1;
+    out.max_peak = out.top_peaks[0].value;
+    out.max_peak_seed = out.top_peaks[0].seed;
+}
+
+// The shared cache is built by the first run that needs it; cache_build is 0 after that
+static void simd_attach_cache(SimdJob& job, CollatzResult& out) {
+    CollatzPerfSession perf;
+    collatz_perf_begin(perf);
+    auto build_start = CollatzClock::now();
+    job.cache = &collatz_cache_acquire(job.log_fd);
+    collatz_perf_end(perf, out.perf_cache_build);
+    out.cache_build_seconds = collatz_seconds_between(build_start, CollatzClock::now());
+}
+
+static int compute_simd_job(SimdJob& job, uint64_t limit, CollatzResult& out, int countThread) {
+    std::string trace_path = collatz_trace_env_path();
+    CollatzTraceSession trace;
+    if (!trace_path.empty()) collatz_trace_start(trace);
+
+    out = CollatzResult{};
+    simd_attach_cache(job, out);
 
     unsigned int num_threads = (countThread > 0) ? countThread : std::thread::hardware_concurrency();
     if (num_threads == 0) num_threads = 4;
@@ -430,48 +856,51 @@ int collatz_compute_simd(uint64_t limit, CollatzResult& out, int countThread) {
     std::cout << "Scalar Fallback" << std::endl;
 #endif
 
-    std::vector<std::thread> threads;
-    uint64_t chunk = limit / num_threads;
-
-    auto start_time = std::chrono::high_resolution_clock::now();
+    out.limit = limit;
+    run_simd(job, 1, limit, out, static_cast<int>(num_threads));
 
-    for (int i = 0; i < num_threads; ++i) {
-        uint64_t s = (i == 0) ? 1 : i * chunk;
-        uint64_t e = (i == num_threads - 1) ? limit : s + chunk;
-        threads.emplace_back(worker_simd, s, e, i);
+    if (!trace_path.empty()) {
+        collatz_trace_stop(trace);
+        write_to_log_simd(job.log_fd, collatz_trace_write(trace, trace_path) ? "  > Trace written to " + trace_path + "\n"
+                                                                             : "  ✗ Could not write trace " + trace_path + "\n");
     }
+    return 0;
+}
 
-    for (auto& t : threads) {
-        if (t.joinable()) t.join();
-    }
+int collatz_compute_simd(uint64_t limit, CollatzResult& out, int countThread) {
+    SimdJob job;
+    return compute_simd_job(job, limit, out, countThread);
+}
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end_time - start_time;
+int collatz_compute_simd_range(uint64_t first, uint64_t last, CollatzResult& out, int countThread, bool quiet) {
+    if (first == 0) first = 1;
+    if (last < first) return -1;
 
-    out.limit = limit;
-    out.seconds = elapsed.count();
-    out.throughput = limit / elapsed.count();
-    out.first_overflow = g_first_overflow.load(std::memory_order_acquire);
-    if (out.first_overflow == UINT64_MAX) out.first_overflow = 0;
-    out.longest_len = g_longest_len.load(std::memory_order_acquire);
-    out.longest_seed = g_longest_seed.load(std::memory_order_acquire);
-    out.max_peak = g_max_peak.load(std::memory_order_acquire);
+    SimdJob job;
+    job.quiet = quiet;
+    out = CollatzResult{};
+    simd_attach_cache(job, out);
 
+    out.limit = last;
+    run_simd(job, first, last + 1, out, countThread);
     return 0;
 }
 
+void collatz_simd_set_logging_enabled(bool enabled) {
+    g_simd_logging_enabled.store(enabled, std::memory_order_relaxed);
+}
+
 int collatz_compute_simd__and_write_pipe_impl(int countThread, uint64_t limit, int result_fd, int log_fd) {
     CollatzResult result{};
+    SimdJob job;
+    job.log_fd = log_fd;
 
-    global_simd__log_fd.store(log_fd, std::memory_order_relaxed);
-
-    int ret = collatz_compute_simd(limit, result, countThread);
+    int ret = compute_simd_job(job, limit, result, countThread);
 
     if (result_fd != -1) {
         ssize_t bytes_written = write(result_fd, &result, sizeof(result));
         if (bytes_written != sizeof(result)) {
             close(result_fd);
-            global_simd__log_fd.store(-1, std::memory_order_relaxed);
             return -2;
         }
         close(result_fd);
@@ -480,7 +909,6 @@ int collatz_compute_simd__and_write_pipe_impl(int countThread, uint64_t limit, i
     if (log_fd != -1) {
         close(log_fd);
     }
-    global_simd__log_fd.store(-1, std::memory_order_relaxed);
 
     return ret;
 }
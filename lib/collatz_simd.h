@@ -0,0 +1,26 @@
+#ifndef COLLATZ_SIMD_H
+#define COLLATZ_SIMD_H
+
+#include <cstdint>
+#include "collatz.h"
+
+// Vector kernel (AVX2 on x86, scalar fallback elsewhere) on the shared step cache.
+// On x86, ranges below 2^32 run in 32-bit lanes (AVX2 or AVX-512, whichever the build
+// targets). Seeds 1..limit-1.
+int collatz_compute_simd(uint64_t limit, CollatzResult& out, int countThread);
+// Seeds first..last; quiet leaves the per-worker lines out of the log (autotune trials)
+int collatz_compute_simd_range(uint64_t first, uint64_t last, CollatzResult& out, int countThread,
+                               bool quiet = false);
+void collatz_simd_set_logging_enabled(bool enabled);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int collatz_compute_simd_and_write_pipe(int countThread, uint64_t limit, int result_fd, int log_fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COLLATZ_SIMD_H
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "collatz_summary.h"
+#include "collatz_records.h"
+
+// ================= RESULTS =================
+void collatz_summary_from_result(const CollatzResult& r, uint64_t first, int32_t kernel, CollatzSummary& out) {
+    std::memset(&out, 0, sizeof(out));
+    out.first = first;
+    out.last = r.limit;
+    out.kernel = kernel;
+    out.all_seeds = r.all_seeds;
+    out.first_overflow = r.first_overflow;
+    std::memcpy(out.histogram, r.histogram, sizeof(out.histogram));
+    std::memcpy(out.top_longest, r.top_longest, sizeof(out.top_longest));
+    std::memcpy(out.top_peaks, r.top_peaks, sizeof(out.top_peaks));
+    out.compute_seconds = r.compute_seconds;
+}
+
+void collatz_summary_fill_result(const CollatzSummary& s, CollatzResult& r) {
+    r.limit = s.last;
+    r.all_seeds = s.all_seeds;
+    r.first_overflow = s.first_overflow;
+    std::memcpy(r.histogram, s.histogram, sizeof(r.histogram));
+    std::memcpy(r.top_longest, s.top_longest, sizeof(r.top_longest));
+    std::memcpy(r.top_peaks, s.top_peaks, sizeof(r.top_peaks));
+    r.longest_len = static_cast<uint32_t>(r.top_longest[0].value);
+    r.longest_seed = r.top_longest[0].seed ? r.top_longest[0].seed : 1;
+    r.max_peak = r.top_peaks[0].value;
+    r.max_peak_seed = r.top_peaks[0].seed;
+}
+
+// Unused slots have seed 0 (no run reports seed 0)
+template<typename Records>
+static void merge_records(CollatzRecord* into, const CollatzRecord* other) {
+    Records records;
+    for (int k = 0; k < COLLATZ_TOP_K; ++k) {
+        if (into[k].seed) records.push(into[k].seed, into[k].value);
+        if (other[k].seed) records.push(other[k].seed, other[k].value);
+    }
+    records.sorted(into);
+}
+
+// Stats only; the callers own the range checks
+static void fold_summary(CollatzSummary& into, const CollatzSummary& other) {
+    into.first_overflow = std::min(into.first_overflow, other.first_overflow);
+    for (int k = 0; k < COLLATZ_HIST_SIZE; ++k) into.histogram[k] += other.histogram[k];
+    merge_records<LongestRecords>(into.top_longest, other.top_longest);
+    merge_records<PeakRecords>(into.top_peaks, other.top_peaks);
+    into.compute_seconds += other.compute_seconds;
+}
+
+bool collatz_summary_merge(CollatzSummary& into, const CollatzSummary& other) {
+    if (into.kernel != other.kernel || into.all_seeds != other.all_seeds) return false;
+    if (into.first <= other.last && other.first <= into.last) return false;
+
+    fold_summary(into, other);
+    into.first = std::min(into.first, other.first);
+    into.last = std::max(into.last, other.last);
+    return true;
+}
+
+// ================= FILES =================
+bool collatz_summary_load(std::vector<CollatzSummary>& list, const std::string& path) {
+    FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp) return false;
+
+    CollatzSummaryHeader header{};
+    bool ok = std::fread(&header, sizeof(header), 1, fp) == 1 &&
+              std::memcmp(header.magic, "CLZSUM1", 8) == 0 &&
+              header.version == COLLATZ_SUMMARY_VERSION;
+    std::vector<CollatzSummary> loaded;
+    if (ok) {
+        loaded.resize(header.count);
+        ok = loaded.empty() || std::fread(loaded.data(), sizeof(CollatzSummary), loaded.size(), fp) == loaded.size();
+    }
+    std::fclose(fp);
+    if (ok) list = std::move(loaded);
+    return ok;
+}
+
+bool collatz_summary_save(const std::vector<CollatzSummary>& list, const std::string& path) {
+    // Written aside and renamed, so a crash never leaves a torn store behind
+    std::string tmp = path + ".tmp";
+    FILE* fp = std::fopen(tmp.c_str(), "wb");
+    if (!fp) return false;
+
+    CollatzSummaryHeader header{};
+    std::memcpy(header.magic, "CLZSUM1", 8);
+    header.version = COLLATZ_SUMMARY_VERSION;
+    header.count = static_cast<uint32_t>(list.size());
+    bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              (list.empty() || std::fwrite(list.data(), sizeof(CollatzSummary), list.size(), fp) == list.size());
+    ok = (std::fclose(fp) == 0) && ok;
+#ifdef _WIN32
+    if (ok) std::remove(path.c_str());
+#endif
+    ok = ok && std::rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok) std::remove(tmp.c_str());
+    return ok;
+}
+
+// ================= SHARDS =================
+bool collatz_shard_write(const CollatzSummary& s, const std::string& path) {
+    return collatz_summary_save(std::vector<CollatzSummary>{s}, path);
+}
+
+bool collatz_shard_read(const std::string& path, CollatzSummary& out) {
+    std::vector<CollatzSummary> list;
+    if (!collatz_summary_load(list, path) || list.size() != 1) return false;
+    out = list[0];
+    return true;
+}
+
+bool collatz_shard_merge_add(CollatzShardMerge& m, const CollatzSummary& s) {
+    if (m.ranges.empty()) {
+        m.total = s;
+    } else {
+        if (m.total.kernel != s.kernel || m.total.all_seeds != s.all_seeds) return false;
+        fold_summary(m.total, s);
+        m.total.first = std::min(m.total.first, s.first);
+        m.total.last = std::max(m.total.last, s.last);
+    }
+    m.ranges.emplace_back(s.first, s.last);
+    return true;
+}
+
+bool collatz_shard_merge_finish(CollatzShardMerge& m, std::vector<CollatzRangeIssue>& issues) {
+    issues.clear();
+    std::sort(m.ranges.begin(), m.ranges.end());
+
+    // covered_to: highest seed covered by the shards so far
+    uint64_t covered_to = 0;
+    for (size_t i = 0; i < m.ranges.size(); ++i) {
+        auto [first, last] = m.ranges[i];
+        if (i > 0 && first > covered_to + 1) {
+            issues.push_back({covered_to + 1, first - 1, false});
+        } else if (i > 0 && first <= covered_to) {
+            issues.push_back({first, std::min(last, covered_to), true});
+        }
+        if (i == 0 || last > covered_to) covered_to = last;
+    }
+    return issues.empty();
+}
+
+// ================= STORE =================
+std::string collatz_summary_store_path() {
+    if (const char* env = std::getenv("COLLATZ_SUMMARIES")) {
+        if (*env) return env;
+    }
+#ifdef _WIN32
+    const char* home = std::getenv("USERPROFILE");
+#else
+    const char* home = std::getenv("HOME");
+#endif
+    std::string dir = (home && *home) ? home : ".";
+    return dir + "/.collatz_summaries";
+}
+
+void collatz_summary_store_put(std::vector<CollatzSummary>& store, const CollatzSummary& s) {
+    auto same = std::find_if(store.begin(), store.end(), [&s](const CollatzSummary& e) {
+        return e.kernel == s.kernel && e.all_seeds == s.all_seeds && e.first == s.first && e.last == s.last;
+    });
+    if (same != store.end()) {
+        *same = s;
+        return;
+    }
+    store.push_back(s);
+    if (store.size() > COLLATZ_SUMMARY_STORE_MAX) {
+        auto shortest = std::min_element(store.begin(), store.end(), [](const CollatzSummary& a, const CollatzSummary& b) {
+            return a.last - a.first < b.last - b.first;
+        });
+        store.erase(shortest);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef COLLATZ_SUMMARY_H
+#define COLLATZ_SUMMARY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include "collatz.h"
+
+// 2: peaks of seeds whose trajectory ends in the cache are exact
+constexpr uint32_t COLLATZ_SUMMARY_VERSION = 2;
+// Summaries kept in the store; the shortest runs are dropped first
+constexpr size_t COLLATZ_SUMMARY_STORE_MAX = 32;
+
+// Mergeable outcome of a run over seeds first..last: histogram, records and overflow of
+// disjoint ranges combine exactly, however the ranges were split. Summaries only merge
+// with the same kernel (peaks are tracked differently) and the same all_seeds.
+struct CollatzSummary {
+    uint64_t first;
+    uint64_t last;
+    int32_t kernel;                 // CollatzKernel
+    uint32_t all_seeds;
+    uint64_t first_overflow;        // INT64_MAX if none
+    uint64_t histogram[COLLATZ_HIST_SIZE];
+    CollatzRecord top_longest[COLLATZ_TOP_K];
+    CollatzRecord top_peaks[COLLATZ_TOP_K];
+    double compute_seconds;         // summed over the runs merged in
+};
+
+// File layout: header, then count CollatzSummary structs
+struct CollatzSummaryHeader {
+    char magic[8];                  // "CLZSUM1"
+    uint32_t version;
+    uint32_t count;
+};
+
+void collatz_summary_from_result(const CollatzResult& r, uint64_t first, int32_t kernel, CollatzSummary& out);
+// Records, histogram, overflow and limit of s into r; phases and counters are left alone
+void collatz_summary_fill_result(const CollatzSummary& s, CollatzResult& r);
+// false (into untouched) if the summaries overlap or do not match in kernel / all_seeds
+bool collatz_summary_merge(CollatzSummary& into, const CollatzSummary& other);
+
+bool collatz_summary_load(std::vector<CollatzSummary>& list, const std::string& path);
+bool collatz_summary_save(const std::vector<CollatzSummary>& list, const std::string& path);
+
+// ----- Shards: one summary per file, merged in any order -----
+// Seeds first..last that no shard covers (gap) or more than one does (overlap)
+struct CollatzRangeIssue {
+    uint64_t first;
+    uint64_t last;
+    bool overlap;
+};
+
+// Streaming merge: each shard's stats are folded in as it is added; only its range is
+// kept (16 bytes), so thousands of shards merge in one pass over the files
+struct CollatzShardMerge {
+    CollatzSummary total{};
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+};
+
+bool collatz_shard_write(const CollatzSummary& s, const std::string& path);
+// false on a missing/outdated file or one that does not hold exactly one summary
+bool collatz_shard_read(const std::string& path, CollatzSummary& out);
+// false (nothing added) if s does not match the kernel / all_seeds of the earlier shards
+bool collatz_shard_merge_add(CollatzShardMerge& m, const CollatzSummary& s);
+// Gaps and overlaps between the shards, in seed order; total spans the lowest to the
+// highest seed covered. Returns true if the shards tile that span exactly once.
+bool collatz_shard_merge_finish(CollatzShardMerge& m, std::vector<CollatzRangeIssue>& issues);
+
+// Store of completed 1..limit runs: $COLLATZ_SUMMARIES, else ~/.collatz_summaries
+std::string collatz_summary_store_path();
+// Replace the entry for the same run (kernel, all_seeds, range) or add it
+void collatz_summary_store_put(std::vector<CollatzSummary>& store, const CollatzSummary& s);
+
+// Hybrid kernel over 1..limit backed by the store: a stored run of the same limit is
+// returned without computing, a shorter one is extended by the seeds above it
+int collatz_compute_incremental(uint64_t limit, CollatzResult& out, const CollatzOptions& opts);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int collatz_compute_incremental_and_write_pipe(const CollatzOptions* opts, uint64_t limit,
+                                               int result_fd, int log_fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COLLATZ_SUMMARY_H
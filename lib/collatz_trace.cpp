@@ -0,0 +1,119 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "collatz_trace.h"
+
+thread_local CollatzTraceSession* t_collatz_trace_session = nullptr;
+
+struct TraceSpan {
+    const char* name;
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    uint64_t arg;
+};
+
+struct CollatzTraceBuffer {
+    int tid;
+    std::thread::id owner;
+    std::string name;
+    std::vector<TraceSpan> spans;
+};
+
+// Buffers outlive their threads (cache build threads are short lived), so the session
+// owns them and each thread only keeps a pointer tagged with the session it belongs to.
+// Pool threads serve several sessions in turn and find their buffer again by owner.
+static std::atomic<uint64_t> g_trace_next_id{1};
+static std::chrono::steady_clock::time_point g_trace_origin = std::chrono::steady_clock::now();
+
+static thread_local CollatzTraceBuffer* t_buffer = nullptr;
+static thread_local uint64_t t_buffer_session = 0;
+
+CollatzTraceSession::CollatzTraceSession() : id(g_trace_next_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+CollatzTraceSession::~CollatzTraceSession() {
+    if (on.load(std::memory_order_relaxed)) collatz_trace_stop(*this);
+}
+
+static CollatzTraceBuffer& thread_buffer(CollatzTraceSession& session) {
+    if (!t_buffer || t_buffer_session != session.id) {
+        std::thread::id self = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(session.mutex);
+        CollatzTraceBuffer* found = nullptr;
+        for (auto& buf : session.buffers) {
+            if (buf->owner == self) { found = buf.get(); break; }
+        }
+        if (!found) {
+            auto buf = std::make_unique<CollatzTraceBuffer>();
+            buf->tid = static_cast<int>(session.buffers.size()) + 1;
+            buf->owner = self;
+            buf->spans.reserve(1024);
+            found = buf.get();
+            session.buffers.push_back(std::move(buf));
+        }
+        t_buffer = found;
+        t_buffer_session = session.id;
+    }
+    return *t_buffer;
+}
+
+uint64_t CollatzTraceScope::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - g_trace_origin).count());
+}
+
+void CollatzTraceScope::record(CollatzTraceSession& session, const char* name, uint64_t begin_ns,
+                               uint64_t end_ns, uint64_t arg) {
+    thread_buffer(session).spans.push_back({name, begin_ns, end_ns, arg});
+}
+
+void collatz_trace_thread_name(const std::string& name) {
+    if (collatz_trace_on()) thread_buffer(*t_collatz_trace_session).name = name;
+}
+
+void collatz_trace_start(CollatzTraceSession& session) {
+    session.outer = t_collatz_trace_session;
+    t_collatz_trace_session = &session;
+    session.on.store(true, std::memory_order_relaxed);
+    collatz_trace_thread_name("main");
+}
+
+void collatz_trace_stop(CollatzTraceSession& session) {
+    session.on.store(false, std::memory_order_relaxed);
+    if (t_collatz_trace_session == &session) t_collatz_trace_session = session.outer;
+}
+
+std::string collatz_trace_env_path() {
+    const char* env = std::getenv("COLLATZ_TRACE");
+    return (env && *env) ? std::string(env) : std::string();
+}
+
+// ================= CHROME JSON =================
+bool collatz_trace_write(CollatzTraceSession& session, const std::string& path) {
+    FILE* fp = std::fopen(path.c_str(), "w");
+    if (!fp) return false;
+
+    std::lock_guard<std::mutex> lock(session.mutex);
+    std::fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    auto sep = [&]() { if (!first) std::fputs(",\n", fp); first = false; };
+
+    for (const auto& buf : session.buffers) {
+        sep();
+        std::fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                     buf->tid, buf->name.empty() ? "thread" : buf->name.c_str());
+        for (const auto& s : buf->spans) {
+            sep();
+            // ts/dur are microseconds; keep the nanoseconds as fractions
+            std::fprintf(fp, "{\"name\":\"%s\",\"cat\":\"collatz\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                             "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"arg\":%llu}}",
+                         s.name, buf->tid, s.begin_ns / 1000.0, (s.end_ns - s.begin_ns) / 1000.0,
+                         static_cast<unsigned long long>(s.arg));
+        }
+    }
+    std::fprintf(fp, "\n]}\n");
+    return std::fclose(fp) == 0;
+}
@@ -0,0 +1,98 @@
+#ifndef COLLATZ_TRACE_H
+#define COLLATZ_TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Timeline tracer. While recording, every thread appends complete spans to its own
+// buffer (no locks after the first span of a thread); collatz_trace_write() dumps all
+// buffers as Chrome trace-event JSON for chrome://tracing or ui.perfetto.dev.
+// Not recording, a span costs one thread-local load.
+//
+// Each traced run records into its own session, bound to the threads that work for it
+// (the pool and the cache build threads carry the binding of the thread that handed them
+// the work), so concurrent runs neither stop nor clear each other's spans.
+
+struct CollatzTraceBuffer;
+
+struct CollatzTraceSession {
+    CollatzTraceSession();
+    ~CollatzTraceSession();
+    CollatzTraceSession(const CollatzTraceSession&) = delete;
+    CollatzTraceSession& operator=(const CollatzTraceSession&) = delete;
+
+    uint64_t id;                        // tags thread buffers; never reused
+    std::atomic<bool> on{false};
+    std::mutex mutex;
+    std::vector<std::unique_ptr<CollatzTraceBuffer>> buffers;
+    CollatzTraceSession* outer = nullptr;   // binding of the starting thread before start
+};
+
+extern thread_local CollatzTraceSession* t_collatz_trace_session;
+
+inline CollatzTraceSession* collatz_trace_current() { return t_collatz_trace_session; }
+inline bool collatz_trace_on() {
+    CollatzTraceSession* s = t_collatz_trace_session;
+    return s && s->on.load(std::memory_order_relaxed);
+}
+
+// Start recording into session and bind it to the calling thread; stop, from the same
+// thread, restores the thread's earlier binding (the destructor stops a session left on)
+void collatz_trace_start(CollatzTraceSession& session);
+void collatz_trace_stop(CollatzTraceSession& session);
+// Write what session recorded; call once the traced threads have been joined
+bool collatz_trace_write(CollatzTraceSession& session, const std::string& path);
+
+// Binds a session to the calling thread for a scope, e.g. a pool task run for a job
+class CollatzTraceBind {
+public:
+    explicit CollatzTraceBind(CollatzTraceSession* session) : outer_(t_collatz_trace_session) {
+        t_collatz_trace_session = session;
+    }
+    ~CollatzTraceBind() { t_collatz_trace_session = outer_; }
+
+    CollatzTraceBind(const CollatzTraceBind&) = delete;
+    CollatzTraceBind& operator=(const CollatzTraceBind&) = delete;
+
+private:
+    CollatzTraceSession* outer_;
+};
+
+// Label the calling thread in the timeline
+void collatz_trace_thread_name(const std::string& name);
+
+// $COLLATZ_TRACE, the trace file compute runs write on their own; empty if unset
+std::string collatz_trace_env_path();
+
+// Span from construction to destruction; arg shows up in the span's args (e.g. first seed)
+class CollatzTraceScope {
+public:
+    explicit CollatzTraceScope(const char* name, uint64_t arg = 0)
+        : session_(collatz_trace_on() ? t_collatz_trace_session : nullptr),
+          name_(name), arg_(arg), begin_(session_ ? now() : 0) {}
+    ~CollatzTraceScope() { if (session_) record(*session_, name_, begin_, now(), arg_); }
+
+    CollatzTraceScope(const CollatzTraceScope&) = delete;
+    CollatzTraceScope& operator=(const CollatzTraceScope&) = delete;
+
+    static uint64_t now();
+    static void record(CollatzTraceSession& session, const char* name, uint64_t begin_ns,
+                       uint64_t end_ns, uint64_t arg);
+
+private:
+    CollatzTraceSession* session_;
+    const char* name_;
+    uint64_t arg_;
+    uint64_t begin_;
+};
+
+#define COLLATZ_TRACE_CAT2(a, b) a##b
+#define COLLATZ_TRACE_CAT(a, b) COLLATZ_TRACE_CAT2(a, b)
+// COLLATZ_TRACE_SCOPE("name") or COLLATZ_TRACE_SCOPE("name", arg) until the end of the block
+#define COLLATZ_TRACE_SCOPE(...) CollatzTraceScope COLLATZ_TRACE_CAT(collatz_trace_, __LINE__)(__VA_ARGS__)
+
+#endif // COLLATZ_TRACE_H
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include "collatz_tree.h"
+#include "collatz_instrument.h"
+#include "collatz_trace.h"
+
+// ================= CONFIGURATION =================
+// Levels are grown breadth-first until one holds this many nodes; each of those then
+// roots a subtree that one thread walks depth-first
+constexpr size_t TREE_FRONTIER_NODES = 1 << 14;
+
+// ================= BOUNDS =================
+// A node n on level d stands for every seed whose trajectory reaches n after d steps,
+// so pruning at limit would lose the seeds that climb above it first. Forward from a
+// seed <= limit, r steps reach at most U(r): U(0) = limit, an odd step is 3n+1, and the
+// best the next one can do is halve it. caps[r] = max U(0..r) is then the largest node
+// that still has a seed <= limit within r levels below it. Saturates at UINT64_MAX.
+static std::vector<uint64_t> level_caps(uint64_t limit, uint32_t levels) {
+    std::vector<uint64_t> caps(levels + 1);
+    uint64_t even = limit;      // U of the last even r
+    caps[0] = limit;
+    for (uint32_t r = 1; r <= levels; ++r) {
+        uint64_t u;
+        if (r & 1) {
+            u = even > (UINT64_MAX - 1) / 3 ? UINT64_MAX : 3 * even + 1;
+        } else {
+            even = even > (UINT64_MAX - 1) / 3 ? UINT64_MAX : (3 * even + 1) / 2;
+            u = even;
+        }
+        caps[r] = std::max(caps[r - 1], u);
+    }
+    return caps;
+}
+
+// ================= WALK =================
+struct TreeWalk {
+    uint64_t limit;
+    uint32_t max_steps;
+    bool all_seeds;
+    uint32_t want_depth;            // seeds on this level are collected (UINT32_MAX: none)
+    std::vector<uint64_t> caps;
+};
+
+// Per-thread slot, merged after the join
+struct TreeSlot {
+    uint64_t counts[COLLATZ_HIST_SIZE] = {0};
+    uint64_t nodes = 0;
+    std::vector<uint64_t> seeds;
+};
+
+struct TreeNode {
+    uint64_t n;
+    uint32_t depth;
+};
+
+// Predecessors of n that can still lead to a seed <= limit: 2n, and (n-1)/3 for
+// n = 4 mod 6 (n = 4 gives the root 1, which is not walked again)
+template<typename Push>
+static inline void expand(const TreeWalk& w, TreeNode v, Push&& push) {
+    if (v.depth == w.max_steps) return;
+    uint64_t cap = w.caps[w.max_steps - v.depth - 1];
+    if (v.n <= cap / 2) push(TreeNode{2 * v.n, v.depth + 1});
+    if (v.n % 6 == 4 && v.n > 4 && (v.n - 1) / 3 <= cap) push(TreeNode{(v.n - 1) / 3, v.depth + 1});
+}
+
+static inline void visit(const TreeWalk& w, TreeNode v, TreeSlot& slot) {
+    slot.nodes++;
+    if (v.n <= w.limit && (w.all_seeds || (v.n & 1))) {
+        slot.counts[v.depth]++;
+        if (v.depth == w.want_depth) slot.seeds.push_back(v.n);
+    }
+}
+
+// Depth-first, so a subtree needs a stack of at most two nodes per level
+static void walk_subtrees(const TreeWalk& w, const std::vector<TreeNode>& roots, size_t first, size_t stride,
+                          TreeSlot& slot) {
+    std::vector<TreeNode> stack;
+    for (size_t i = first; i < roots.size(); i += stride) {
+        stack.push_back(roots[i]);
+        while (!stack.empty()) {
+            TreeNode v = stack.back();
+            stack.pop_back();
+            visit(w, v, slot);
+            expand(w, v, [&](TreeNode c) { stack.push_back(c); });
+        }
+    }
+}
+
+static void grow_tree(const TreeWalk& w, TreeSlot& total, uint64_t& frontier) {
+    // Breadth-first prefix, visited on the calling thread
+    std::vector<TreeNode> level{{1, 0}}, next;
+    while (!level.empty() && level.size() < TREE_FRONTIER_NODES && level[0].depth < w.max_steps) {
+        next.clear();
+        for (TreeNode v : level) {
+            visit(w, v, total);
+            expand(w, v, [&](TreeNode c) { next.push_back(c); });
+        }
+        level.swap(next);
+    }
+    frontier = level.size();
+
+    // Subtrees dealt round-robin: neighbouring roots have similar sizes
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 4;
+    if (num_threads > level.size()) num_threads = static_cast<unsigned int>(std::max<size_t>(level.size(), 1));
+
+    std::vector<TreeSlot> slots(num_threads);
+    std::vector<std::thread> threads;
+    CollatzTraceSession* trace = collatz_trace_current();
+    for (unsigned int t = 1; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            CollatzTraceBind bind(trace);
+            collatz_trace_thread_name("tree worker " + std::to_string(t));
+            COLLATZ_TRACE_SCOPE("tree subtrees", t);
+            walk_subtrees(w, level, t, num_threads, slots[t]);
+        });
+    }
+    {
+        COLLATZ_TRACE_SCOPE("tree subtrees", 0);
+        walk_subtrees(w, level, 0, num_threads, slots[0]);
+    }
+    for (auto& t : threads) t.join();
+
+    for (const TreeSlot& slot : slots) {
+        for (uint32_t k = 0; k <= w.max_steps; ++k) total.counts[k] += slot.counts[k];
+        total.nodes += slot.nodes;
+        total.seeds.insert(total.seeds.end(), slot.seeds.begin(), slot.seeds.end());
+    }
+}
+
+static bool tree_args_ok(uint64_t limit, uint32_t max_steps) {
+    return limit > 0 && max_steps <= COLLATZ_TREE_MAX_STEPS;
+}
+
+// ================= PUBLIC =================
+int collatz_tree_count(uint64_t limit, uint32_t max_steps, bool all_seeds, CollatzTreeResult& out) {
+    std::memset(&out, 0, sizeof(out));
+    if (!tree_args_ok(limit, max_steps)) return -1;
+    out.limit = limit;
+    out.max_steps = max_steps;
+    out.all_seeds = all_seeds;
+
+    COLLATZ_TRACE_SCOPE("tree count", limit);
+    auto start = CollatzClock::now();
+    TreeWalk w{limit, max_steps, all_seeds, UINT32_MAX, level_caps(limit, max_steps)};
+    TreeSlot total;
+    grow_tree(w, total, out.frontier);
+    std::memcpy(out.counts, total.counts, sizeof(out.counts));
+    out.nodes = total.nodes;
+    out.seconds = collatz_seconds_between(start, CollatzClock::now());
+    return 0;
+}
+
+int collatz_tree_seeds(uint64_t limit, uint32_t steps, bool all_seeds, std::vector<uint64_t>& out) {
+    out.clear();
+    if (!tree_args_ok(limit, steps)) return -1;
+
+    COLLATZ_TRACE_SCOPE("tree seeds", steps);
+    TreeWalk w{limit, steps, all_seeds, steps, level_caps(limit, steps)};
+    TreeSlot total;
+    uint64_t frontier = 0;
+    grow_tree(w, total, frontier);
+    out = std::move(total.seeds);
+    std::sort(out.begin(), out.end());
+    return 0;
+}
+
+int collatz_tree_check_histogram(const CollatzResult& r, uint32_t max_steps) {
+    CollatzTreeResult tree;
+    if (collatz_tree_count(r.limit, max_steps, r.all_seeds != 0, tree) != 0) return 0;
+    if (!r.all_seeds) tree.counts[0] -= 1;
+    for (uint32_t k = 0; k <= max_steps; ++k) {
+        if (tree.counts[k] != r.histogram[k]) return static_cast<int>(k);
+    }
+    return -1;
+}
@@ -0,0 +1,38 @@
+#ifndef COLLATZ_TREE_H
+#define COLLATZ_TREE_H
+
+#include <cstdint>
+#include <vector>
+#include "collatz.h"
+
+// Deepest level the tree engine grows: counts share the histogram's buckets and the
+// last bucket of those also holds every longer trajectory
+constexpr uint32_t COLLATZ_TREE_MAX_STEPS = COLLATZ_HIST_SIZE - 2;
+
+// Seeds 1..limit by exact step count, found by growing the inverse tree from 1 (the
+// predecessors of n are 2n and, for n = 4 mod 6, (n-1)/3) instead of walking every seed
+// forward. Only levels up to max_steps are grown, so small step counts are cheap at any
+// limit; the tree roughly grows by 4/3 per level, so the cost does too. Seeds whose
+// trajectory leaves 64 bits are not reached.
+struct CollatzTreeResult {
+    uint64_t limit;
+    uint32_t max_steps;
+    uint32_t all_seeds;             // 0: odd seeds only, like the default histogram
+    uint64_t counts[COLLATZ_HIST_SIZE]; // counts[k]: seeds with exactly k steps, k <= max_steps
+    uint64_t nodes;                 // tree nodes generated
+    uint64_t frontier;              // subtrees split across the threads
+    double seconds;
+};
+
+// -1 if limit is 0 or max_steps is above COLLATZ_TREE_MAX_STEPS
+int collatz_tree_count(uint64_t limit, uint32_t max_steps, bool all_seeds, CollatzTreeResult& out);
+// Every seed 1..limit with exactly steps steps, ascending; -1 on the same bad arguments
+int collatz_tree_seeds(uint64_t limit, uint32_t steps, bool all_seeds, std::vector<uint64_t>& out);
+
+// Cross-check of a hybrid run over 1..r.limit: the first step count up to max_steps
+// whose histogram bucket differs from the tree's count, -1 if they all agree (0 if the
+// tree cannot be grown for r.limit / max_steps).
+// The forward kernels do not count seed 1 in odd-seed runs; that is allowed for.
+int collatz_tree_check_histogram(const CollatzResult& r, uint32_t max_steps);
+
+#endif // COLLATZ_TREE_H
@@ -0,0 +1,233 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include "platform_compat.h"
+#include "collatz_tune.h"
+#include "collatz_simd.h"
+#include "collatz_cache.h"
+
+// ================= HELPER ========================
+// write to the log pipe of the tune run (-1: console only)
+static void write_to_log_tune(int log_fd, const std::string& message) {
+    if (log_fd != -1) {
+        write(log_fd, message.c_str(), static_cast<unsigned int>(message.length()));
+    }
+    std::cout << message << std::flush;
+}
+
+// ================= CONFIGURATION =================
+// Upper end of each band; the trial window sits just below it. The open band is
+// timed at 1e12, where trajectories are already well above the cache.
+constexpr uint64_t TUNE_BANDS[] = {10000000ULL, 1000000000ULL, 10000000000ULL, UINT64_MAX};
+constexpr uint64_t TUNE_OPEN_BAND_SEED = 1000000000000ULL;
+constexpr uint64_t TUNE_WINDOW = 1ULL << 22;   // seeds per trial, at least 1M per thread
+constexpr int TUNE_REPEATS = 2;                // best of N hides one-off scheduling noise
+constexpr const char* PROFILE_MAGIC = "collatz-profile 1";
+
+// ================= PROFILE FILE =================
+std::string collatz_host_id() {
+    char name[256] = {0};
+#ifdef _WIN32
+    DWORD size = sizeof(name);
+    if (!GetComputerNameA(name, &size)) name[0] = 0;
+#else
+    if (gethostname(name, sizeof(name) - 1) != 0) name[0] = 0;
+#endif
+    std::ostringstream oss;
+    oss << (name[0] ? name : "unknown") << "/" << std::thread::hardware_concurrency();
+    return oss.str();
+}
+
+std::string collatz_profile_path() {
+    if (const char* env = std::getenv("COLLATZ_PROFILE")) {
+        if (*env) return env;
+    }
+#ifdef _WIN32
+    const char* home = std::getenv("USERPROFILE");
+#else
+    const char* home = std::getenv("HOME");
+#endif
+    std::string dir = (home && *home) ? home : ".";
+    return dir + "/.collatz_profile";
+}
+
+// Format:
+//   collatz-profile 1
+//   host <id>
+//   band <max_limit|max> <hybrid|simd> <threads> <lanes> <seeds/s>
+bool collatz_profile_load(CollatzProfile& profile, const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    if (!std::getline(in, line) || line != PROFILE_MAGIC) return false;
+
+    CollatzProfile loaded;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string key;
+        if (!(iss >> key) || key[0] == '#') continue;
+
+        if (key == "host") {
+            iss >> loaded.host;
+        } else if (key == "band") {
+            std::string limit, kernel;
+            CollatzProfileEntry e{};
+            if (!(iss >> limit >> kernel >> e.threads >> e.lanes >> e.throughput)) return false;
+            e.max_limit = (limit == "max") ? UINT64_MAX : std::strtoull(limit.c_str(), nullptr, 10);
+            e.kernel = (kernel == "simd") ? COLLATZ_KERNEL_SIMD : COLLATZ_KERNEL_HYBRID;
+            if (e.threads < 1) e.threads = 1;
+            loaded.bands.push_back(e);
+        }
+    }
+
+    // Thread counts and timings from another machine are meaningless here
+    if (loaded.host != collatz_host_id() || loaded.bands.empty()) return false;
+
+    std::sort(loaded.bands.begin(), loaded.bands.end(),
+              [](const CollatzProfileEntry& a, const CollatzProfileEntry& b) { return a.max_limit < b.max_limit; });
+    profile = loaded;
+    return true;
+}
+
+bool collatz_profile_save(const CollatzProfile& profile, const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+
+    out << PROFILE_MAGIC << "\n";
+    out << "host " << profile.host << "\n";
+    for (const auto& e : profile.bands) {
+        out << "band ";
+        if (e.max_limit == UINT64_MAX) out << "max";
+        else out << e.max_limit;
+        out << " " << (e.kernel == COLLATZ_KERNEL_SIMD ? "simd" : "hybrid")
+            << " " << e.threads << " " << e.lanes
+            << " " << std::fixed << std::setprecision(0) << e.throughput << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+const CollatzProfileEntry* collatz_profile_lookup(const CollatzProfile& profile, uint64_t limit) {
+    if (profile.bands.empty()) return nullptr;
+    for (const auto& e : profile.bands) {
+        if (limit <= e.max_limit) return &e;
+    }
+    return &profile.bands.back();
+}
+
+// ================= TRIALS =================
+// Trials are quiet runs of their own: their worker lines stay out of the tune's log
+// without muting the kernels for other runs
+static bool run_trial(const CollatzProfileEntry& cfg, uint64_t first, uint64_t last, CollatzResult& out) {
+    double best = 0;
+    for (int r = 0; r < TUNE_REPEATS; ++r) {
+        CollatzResult res{};
+        int ret;
+        if (cfg.kernel == COLLATZ_KERNEL_SIMD) {
+            ret = collatz_compute_simd_range(first, last, res, cfg.threads, true);
+        } else {
+            CollatzOptions opts;
+            opts.threads = cfg.threads;
+            opts.lanes = cfg.lanes;
+            opts.quiet = true;
+            ret = collatz_compute_range(first, last, res, opts);
+        }
+        double seconds = res.compute_seconds + res.merge_seconds;
+        if (ret != 0 || seconds <= 0) return false;
+        if (r == 0 || seconds < best) {
+            best = seconds;
+            out = res;
+        }
+    }
+    return true;
+}
+
+int collatz_autotune(CollatzProfile& profile, CollatzResult& best, int log_fd) {
+    unsigned int hw = std::thread::hardware_concurrency();
+    if (hw == 0) hw = 1;
+
+    std::vector<int> thread_counts;
+    for (unsigned int t = 1; t < hw; t *= 2) thread_counts.push_back(static_cast<int>(t));
+    thread_counts.push_back(static_cast<int>(hw));
+
+    std::vector<CollatzProfileEntry> candidates;
+    for (int t : thread_counts) {
+        for (int lanes : COLLATZ_LANE_WIDTHS) {
+            candidates.push_back({0, COLLATZ_KERNEL_HYBRID, t, lanes, 0});
+        }
+        candidates.push_back({0, COLLATZ_KERNEL_SIMD, t, 0, 0});
+    }
+
+    const uint64_t window = std::max<uint64_t>(TUNE_WINDOW, static_cast<uint64_t>(hw) << 20);
+
+    std::ostringstream oss;
+    oss << "  > Autotune on " << collatz_host_id() << ": " << candidates.size()
+        << " configurations x " << std::size(TUNE_BANDS) << " bands\n";
+    write_to_log_tune(log_fd, oss.str());
+
+    // Both kernels read the shared cache; build it once, outside the timed trials
+    collatz_cache_acquire(log_fd);
+
+    profile.host = collatz_host_id();
+    profile.bands.clear();
+
+    for (uint64_t band : TUNE_BANDS) {
+        uint64_t last = (band == UINT64_MAX) ? TUNE_OPEN_BAND_SEED : band;
+        uint64_t first = last > window ? last - window + 1 : 1;
+
+        CollatzProfileEntry winner{};
+        for (CollatzProfileEntry cfg : candidates) {
+            CollatzResult res{};
+            if (!run_trial(cfg, first, last, res)) continue;
+            cfg.throughput = static_cast<double>(last - first + 1) / (res.compute_seconds + res.merge_seconds);
+            if (cfg.throughput > winner.throughput) {
+                winner = cfg;
+                best = res;
+            }
+        }
+        winner.max_limit = band;
+
+        oss.str("");
+        oss << "    band <= " << (band == UINT64_MAX ? std::string("max") : format_number(band)) << ": "
+            << (winner.kernel == COLLATZ_KERNEL_SIMD ? "SIMD" : "Hybrid") << ", "
+            << winner.threads << " threads";
+        if (winner.kernel == COLLATZ_KERNEL_HYBRID) oss << ", " << winner.lanes << " lanes";
+        oss << " (" << std::fixed << std::setprecision(1) << winner.throughput / 1e6 << " M seeds/s)\n";
+        write_to_log_tune(log_fd, oss.str());
+
+        profile.bands.push_back(winner);
+    }
+
+    return profile.bands.empty() ? -1 : 0;
+}
+
+// ================= PIPE ENTRY =================
+extern "C" int collatz_autotune_and_write_pipe(int result_fd, int log_fd) {
+    CollatzResult result{};
+    CollatzProfile profile;
+
+    int ret = collatz_autotune(profile, result, log_fd);
+    if (ret == 0) {
+        std::string path = collatz_profile_path();
+        if (collatz_profile_save(profile, path)) {
+            write_to_log_tune(log_fd, "  ✓ Profile saved to " + path + "\n");
+        } else {
+            write_to_log_tune(log_fd, "  ✗ Could not write " + path + "\n");
+            ret = -3;
+        }
+    }
+
+    if (result_fd != -1) {
+        ssize_t bytes_written = write(result_fd, &result, sizeof(result));
+        close(result_fd);
+        if (bytes_written != static_cast<ssize_t>(sizeof(result))) ret = -2;
+    }
+    if (log_fd != -1) {
+        close(log_fd);
+    }
+    return ret;
+}
@@ -0,0 +1,55 @@
+#ifndef COLLATZ_TUNE_H
+#define COLLATZ_TUNE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "collatz.h"
+
+enum CollatzKernel : int32_t {
+    COLLATZ_KERNEL_HYBRID = 0,  // scalar N-way interleaved kernel (collatz.cpp)
+    COLLATZ_KERNEL_SIMD   = 1   // vector kernel (collatz_simd.cpp)
+};
+
+// Best configuration measured for limits up to max_limit
+struct CollatzProfileEntry {
+    uint64_t max_limit;
+    int32_t kernel;         // CollatzKernel
+    int32_t threads;
+    int32_t lanes;          // hybrid kernel only
+    double throughput;      // seeds per second in the trial
+};
+
+// Bands are sorted by max_limit; the last one covers everything above
+struct CollatzProfile {
+    std::string host;
+    std::vector<CollatzProfileEntry> bands;
+};
+
+// Hostname and hardware thread count; a profile from another host is not loaded
+std::string collatz_host_id();
+// $COLLATZ_PROFILE, else ~/.collatz_profile (%USERPROFILE% on Windows)
+std::string collatz_profile_path();
+
+bool collatz_profile_load(CollatzProfile& profile, const std::string& path);
+bool collatz_profile_save(const CollatzProfile& profile, const std::string& path);
+// Band covering limit, nullptr if the profile is empty
+const CollatzProfileEntry* collatz_profile_lookup(const CollatzProfile& profile, uint64_t limit);
+
+// Time every kernel / thread count / lane width on a short window at the top of each
+// band and keep the fastest. best receives the winning trial of the last band; progress
+// goes to log_fd (-1: console only).
+int collatz_autotune(CollatzProfile& profile, CollatzResult& best, int log_fd = -1);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tune, save the profile to collatz_profile_path() and write the last band's best trial
+int collatz_autotune_and_write_pipe(int result_fd, int log_fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COLLATZ_TUNE_H
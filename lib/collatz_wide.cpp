@@ -0,0 +1,429 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include "platform_compat.h"
+#include "collatz_wide.h"
+#include "collatz_cache.h"
+#include "collatz_pool.h"
+#include "collatz_records.h"
+#include "collatz_instrument.h"
+#include "collatz_trace.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define WIDE_AVX2
+#endif
+
+static std::atomic<bool> g_wide_logging_enabled{true};
+
+// ================= HELPER ========================
+// write to the log pipe of a run (-1: console only)
+static void write_to_log_wide(int log_fd, const std::string& message) {
+    if (!g_wide_logging_enabled.load(std::memory_order_relaxed)) return;
+    COLLATZ_TRACE_SCOPE("log flush");
+    if (log_fd != -1) {
+        write(log_fd, message.c_str(), static_cast<unsigned int>(message.length()));
+    }
+    std::cout << message << std::flush;
+}
+
+// ================= CONFIGURATION =================
+// Largest odd n whose 3n+1 still fits in 128 bits: (2^128 - 2) / 3
+constexpr uint64_t OVERFLOW_HI = 0x5555555555555555ULL;
+constexpr uint64_t OVERFLOW_LO = 0x5555555555555554ULL;
+constexpr int WIDE_VECTORS = 4;                 // interleaved registers per block
+constexpr int WIDE_BLOCK = WIDE_VECTORS * 4;    // 4 lanes per register
+constexpr uint64_t WIDE_MAX_COUNT = 1ULL << 63;
+
+// ================= 128-BIT HELPERS =================
+static inline bool u128_gt(uint64_t a_hi, uint64_t a_lo, uint64_t b_hi, uint64_t b_lo) {
+    return a_hi != b_hi ? a_hi > b_hi : a_lo > b_lo;
+}
+
+static inline CollatzU128 u128_add(CollatzU128 a, uint64_t b) {
+    CollatzU128 r{a.hi, a.lo + b};
+    if (r.lo < b) r.hi++;
+    return r;
+}
+
+// Four 32-bit words, most significant first, for decimal parsing and printing
+static void u128_to_words(CollatzU128 v, uint32_t w[4]) {
+    w[0] = static_cast<uint32_t>(v.hi >> 32); w[1] = static_cast<uint32_t>(v.hi);
+    w[2] = static_cast<uint32_t>(v.lo >> 32); w[3] = static_cast<uint32_t>(v.lo);
+}
+
+static CollatzU128 u128_from_words(const uint32_t w[4]) {
+    return {(static_cast<uint64_t>(w[0]) << 32) | w[1], (static_cast<uint64_t>(w[2]) << 32) | w[3]};
+}
+
+// w = w * mul + add; false if the result does not fit
+static bool words_muladd(uint32_t w[4], uint32_t mul, uint32_t add) {
+    uint64_t carry = add;
+    for (int i = 3; i >= 0; --i) {
+        uint64_t t = static_cast<uint64_t>(w[i]) * mul + carry;
+        w[i] = static_cast<uint32_t>(t);
+        carry = t >> 32;
+    }
+    return carry == 0;
+}
+
+// w = w / div, returns the remainder
+static uint32_t words_divmod(uint32_t w[4], uint32_t div) {
+    uint64_t rem = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t cur = (rem << 32) | w[i];
+        w[i] = static_cast<uint32_t>(cur / div);
+        rem = cur % div;
+    }
+    return static_cast<uint32_t>(rem);
+}
+
+bool collatz_u128_parse(const std::string& text, CollatzU128& out) {
+    uint32_t w[4] = {0, 0, 0, 0};
+    size_t pos = 0;
+    uint32_t base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        pos = 2;
+    }
+    if (pos >= text.size()) return false;
+
+    for (; pos < text.size(); ++pos) {
+        char c = text[pos];
+        uint32_t d;
+        if (c >= '0' && c <= '9') d = static_cast<uint32_t>(c - '0');
+        else if (base == 16 && c >= 'a' && c <= 'f') d = static_cast<uint32_t>(c - 'a' + 10);
+        else if (base == 16 && c >= 'A' && c <= 'F') d = static_cast<uint32_t>(c - 'A' + 10);
+        else if (c == '\'' || c == '_' || c == ',') continue;   // digit separators
+        else return false;
+        if (d >= base || !words_muladd(w, base, d)) return false;
+    }
+    out = u128_from_words(w);
+    return true;
+}
+
+std::string collatz_u128_to_string(CollatzU128 v) {
+    if (v.hi == 0) return std::to_string(v.lo);
+    uint32_t w[4];
+    u128_to_words(v, w);
+    std::string digits;
+    while (w[0] | w[1] | w[2] | w[3]) {
+        digits.push_back(static_cast<char>('0' + words_divmod(w, 10)));
+    }
+    std::reverse(digits.begin(), digits.end());
+    return digits;
+}
+
+// ================= KERNEL =================
+// Each lane runs n -> n/2 (even) or (3n+1)/2 = n + n/2 + 1 (odd) until n drops below
+// the cache. ph/pl keep the largest (3n+1)/2, i.e. half the peak; ovf is set for lanes
+// that stopped because 3n+1 would not fit.
+static inline void walk_lane_wide(uint64_t& lo, uint64_t& hi, uint64_t& steps,
+                                  uint64_t& pl, uint64_t& ph, uint64_t& ovf) {
+    while (hi != 0 || lo >= COLLATZ_CACHE_LIMIT) {
+        uint64_t half_lo = (lo >> 1) | (hi << 63);
+        uint64_t half_hi = hi >> 1;
+        if (lo & 1) {
+            if (u128_gt(hi, lo, OVERFLOW_HI, OVERFLOW_LO)) { ovf = 1; return; }
+            uint64_t sum_lo = lo + half_lo;
+            uint64_t carry = sum_lo < lo;
+            sum_lo += 1;
+            carry += sum_lo == 0;
+            hi = hi + half_hi + carry;
+            lo = sum_lo;
+            if (u128_gt(hi, lo, ph, pl)) { ph = hi; pl = lo; }
+            steps += 2;
+        } else {
+            lo = half_lo;
+            hi = half_hi;
+            steps += 1;
+        }
+    }
+}
+
+#ifdef WIDE_AVX2
+// Same walk, 4 lanes per register. AVX2 has no carry flag or unsigned compare: carries
+// come from sign-flipped compares (sum < addend), which give -1 per lane and are
+// subtracted from the high limb.
+static void walk_lanes_wide(uint64_t* lo, uint64_t* hi, uint64_t* steps,
+                            uint64_t* pl, uint64_t* ph, uint64_t* ovf) {
+    const __m256i v_flip  = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+    const __m256i v_zero  = _mm256_setzero_si256();
+    const __m256i v_one   = _mm256_set1_epi64x(1);
+    const __m256i v_two   = _mm256_set1_epi64x(2);
+    const __m256i v_limit = _mm256_set1_epi64x(static_cast<long long>((COLLATZ_CACHE_LIMIT - 1) ^ 0x8000000000000000ULL));
+    const __m256i v_ovf_hi = _mm256_set1_epi64x(static_cast<long long>(OVERFLOW_HI ^ 0x8000000000000000ULL));
+    const __m256i v_ovf_lo = _mm256_set1_epi64x(static_cast<long long>(OVERFLOW_LO ^ 0x8000000000000000ULL));
+
+    auto gtu = [&](__m256i a, __m256i b) {
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(a, v_flip), _mm256_xor_si256(b, v_flip));
+    };
+    // a > b on (hi, lo) pairs whose second operand is already sign-flipped
+    auto gt128_flipped = [&](__m256i a_hi, __m256i a_lo, __m256i b_hi_f, __m256i b_lo_f) {
+        __m256i ah = _mm256_xor_si256(a_hi, v_flip);
+        __m256i hi_gt = _mm256_cmpgt_epi64(ah, b_hi_f);
+        __m256i hi_eq = _mm256_cmpeq_epi64(ah, b_hi_f);
+        __m256i lo_gt = _mm256_cmpgt_epi64(_mm256_xor_si256(a_lo, v_flip), b_lo_f);
+        return _mm256_or_si256(hi_gt, _mm256_and_si256(hi_eq, lo_gt));
+    };
+    auto above_cache = [&](__m256i h, __m256i l) {
+        __m256i hi_set = _mm256_xor_si256(_mm256_cmpeq_epi64(h, v_zero), _mm256_set1_epi64x(-1));
+        return _mm256_or_si256(hi_set, _mm256_cmpgt_epi64(_mm256_xor_si256(l, v_flip), v_limit));
+    };
+
+    __m256i L[WIDE_VECTORS], H[WIDE_VECTORS], S[WIDE_VECTORS], PL[WIDE_VECTORS], PH[WIDE_VECTORS];
+    __m256i M[WIDE_VECTORS], O[WIDE_VECTORS];
+    for (int q = 0; q < WIDE_VECTORS; ++q) {
+        L[q] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo + 4 * q));
+        H[q] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi + 4 * q));
+        S[q] = v_zero; PL[q] = v_zero; PH[q] = v_zero; O[q] = v_zero;
+        M[q] = above_cache(H[q], L[q]);
+    }
+
+    for (;;) {
+        __m256i any = _mm256_or_si256(_mm256_or_si256(M[0], M[1]), _mm256_or_si256(M[2], M[3]));
+        if (_mm256_testz_si256(any, any)) break;
+
+        for (int q = 0; q < WIDE_VECTORS; ++q) {
+            __m256i half_lo = _mm256_or_si256(_mm256_srli_epi64(L[q], 1), _mm256_slli_epi64(H[q], 63));
+            __m256i half_hi = _mm256_srli_epi64(H[q], 1);
+            __m256i odd = _mm256_cmpeq_epi64(_mm256_and_si256(L[q], v_one), v_one);
+
+            __m256i ovf = _mm256_and_si256(_mm256_and_si256(odd, M[q]),
+                                           gt128_flipped(H[q], L[q], v_ovf_hi, v_ovf_lo));
+            O[q] = _mm256_or_si256(O[q], ovf);
+            __m256i m = _mm256_andnot_si256(ovf, M[q]);
+
+            // n + n/2 + 1 with both carries out of the low limb
+            __m256i sum_lo = _mm256_add_epi64(L[q], half_lo);
+            __m256i c1 = gtu(L[q], sum_lo);
+            sum_lo = _mm256_add_epi64(sum_lo, v_one);
+            __m256i c2 = _mm256_cmpeq_epi64(sum_lo, v_zero);
+            __m256i sum_hi = _mm256_sub_epi64(_mm256_sub_epi64(_mm256_add_epi64(H[q], half_hi), c1), c2);
+
+            __m256i peak_upd = _mm256_and_si256(_mm256_and_si256(odd, m),
+                                                gt128_flipped(sum_hi, sum_lo,
+                                                              _mm256_xor_si256(PH[q], v_flip),
+                                                              _mm256_xor_si256(PL[q], v_flip)));
+            PL[q] = _mm256_blendv_epi8(PL[q], sum_lo, peak_upd);
+            PH[q] = _mm256_blendv_epi8(PH[q], sum_hi, peak_upd);
+
+            __m256i next_lo = _mm256_blendv_epi8(half_lo, sum_lo, odd);
+            __m256i next_hi = _mm256_blendv_epi8(half_hi, sum_hi, odd);
+            __m256i inc = _mm256_blendv_epi8(v_one, v_two, odd);
+            L[q] = _mm256_blendv_epi8(L[q], next_lo, m);
+            H[q] = _mm256_blendv_epi8(H[q], next_hi, m);
+            S[q] = _mm256_add_epi64(S[q], _mm256_and_si256(inc, m));
+            M[q] = _mm256_andnot_si256(O[q], above_cache(H[q], L[q]));
+        }
+    }
+
+    for (int q = 0; q < WIDE_VECTORS; ++q) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo + 4 * q), L[q]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hi + 4 * q), H[q]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(steps + 4 * q), S[q]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pl + 4 * q), PL[q]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(ph + 4 * q), PH[q]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(ovf + 4 * q), _mm256_and_si256(O[q], v_one));
+    }
+}
+#else
+static void walk_lanes_wide(uint64_t* lo, uint64_t* hi, uint64_t* steps,
+                            uint64_t* pl, uint64_t* ph, uint64_t* ovf) {
+    for (int k = 0; k < WIDE_BLOCK; ++k) {
+        steps[k] = pl[k] = ph[k] = ovf[k] = 0;
+        walk_lane_wide(lo[k], hi[k], steps[k], pl[k], ph[k], ovf[k]);
+    }
+}
+#endif
+
+// ================= WORKER =================
+struct WideThreadResult {
+    LongestRecords longest;
+    CollatzU128 peak{0, 0};
+    uint64_t peak_offset = UINT64_MAX;
+    uint64_t overflow_count = 0;
+    uint64_t first_overflow_offset = UINT64_MAX;
+    CollatzClock::time_point finished;
+
+    // Larger peak wins, ties go to the smaller seed
+    void push_peak(uint64_t offset, CollatzU128 value) {
+        if (u128_gt(value.hi, value.lo, peak.hi, peak.lo) ||
+            (value.hi == peak.hi && value.lo == peak.lo && offset < peak_offset)) {
+            peak = value;
+            peak_offset = offset;
+        }
+    }
+};
+
+// ================= JOB =================
+// Everything one wide run writes; runs only share the cache and the pool
+struct WideJob {
+    int log_fd = -1;
+    const CollatzCacheTables* cache = nullptr;
+    // One slot per worker, indexed by thread_id
+    std::vector<WideThreadResult> results;
+};
+
+// Seed first + offset is done: lo holds its final index below the cache
+static inline void finish_lane(WideThreadResult& res, const CollatzCacheTables& cache, CollatzU128 seed,
+                               uint64_t offset, uint64_t lo, uint64_t steps, uint64_t pl, uint64_t ph,
+                               uint64_t ovf) {
+    if (ovf) {
+        res.overflow_count++;
+        res.first_overflow_offset = std::min(res.first_overflow_offset, offset);
+        return;
+    }
+    steps += cache.steps[lo];
+    if (res.longest.accepts(steps)) res.longest.push(offset, steps);
+    // Below the cache nothing was walked and the peak so far is the seed itself. The rest
+    // of the trajectory runs inside the cache, whose peaks all fit in 64 bits.
+    CollatzU128 peak = (ph | pl) ? CollatzU128{(ph << 1) | (pl >> 63), pl << 1} : seed;
+    if (peak.hi == 0) peak.lo = collatz_cache_peak(cache, lo >> std::countr_zero(lo), peak.lo);
+    res.push_peak(offset, peak);
+}
+
+// Odd seeds among offsets [begin, end) of the window
+static void worker_wide(WideJob& job, CollatzU128 first, uint64_t begin, uint64_t end, int thread_id) {
+    WideThreadResult res;
+    const CollatzCacheTables& cache = *job.cache;
+    if (collatz_trace_on()) collatz_trace_thread_name("wide worker " + std::to_string(thread_id));
+    CollatzTraceScope span("wide worker", begin);
+
+    uint64_t o = begin;
+    if (((first.lo + o) & 1) == 0) o++;
+
+    for (; o < end && end - o > 2 * static_cast<uint64_t>(WIDE_BLOCK - 1); o += 2 * WIDE_BLOCK) {
+        alignas(32) uint64_t lo[WIDE_BLOCK], hi[WIDE_BLOCK], steps[WIDE_BLOCK];
+        alignas(32) uint64_t pl[WIDE_BLOCK], ph[WIDE_BLOCK], ovf[WIDE_BLOCK];
+        for (int k = 0; k < WIDE_BLOCK; ++k) {
+            CollatzU128 seed = u128_add(first, o + 2 * static_cast<uint64_t>(k));
+            lo[k] = seed.lo;
+            hi[k] = seed.hi;
+        }
+
+        walk_lanes_wide(lo, hi, steps, pl, ph, ovf);
+
+        for (int k = 0; k < WIDE_BLOCK; ++k) {
+            uint64_t offset = o + 2 * static_cast<uint64_t>(k);
+            finish_lane(res, cache, u128_add(first, offset), offset, lo[k], steps[k], pl[k], ph[k], ovf[k]);
+        }
+    }
+
+    // Scalar Cleanup
+    for (; o < end; o += 2) {
+        CollatzU128 seed = u128_add(first, o);
+        uint64_t lo = seed.lo, hi = seed.hi, steps = 0, pl = 0, ph = 0, ovf = 0;
+        walk_lane_wide(lo, hi, steps, pl, ph, ovf);
+        finish_lane(res, cache, seed, o, lo, steps, pl, ph, ovf);
+    }
+
+    res.finished = CollatzClock::now();
+    job.results[thread_id] = res;
+}
+
+// ================= MAIN =================
+static int compute_wide_job(WideJob& job, CollatzU128 first, uint64_t count, CollatzWideResult& out,
+                            int countThread) {
+    out = CollatzWideResult{};
+    out.first = first;
+    out.count = count;
+    // Offsets stay far from wrapping; the last seed must still fit in 128 bits
+    if (count == 0 || count > WIDE_MAX_COUNT) return -1;
+    if (first.hi == UINT64_MAX && first.lo > UINT64_MAX - (count - 1)) return -1;
+
+    unsigned int num_threads = (countThread > 0) ? countThread : std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 4;
+    if (num_threads > count) num_threads = static_cast<unsigned int>(count);
+
+    std::ostringstream oss;
+    oss << "  > Wide window " << collatz_u128_to_string(first) << " + " << format_number(count)
+        << " with " << num_threads << " threads\n";
+    write_to_log_wide(job.log_fd, oss.str());
+
+    auto build_start = CollatzClock::now();
+    job.cache = &collatz_cache_acquire(job.log_fd);
+    auto start_time = CollatzClock::now();
+    out.cache_build_seconds = collatz_seconds_between(build_start, start_time);
+
+    job.results.clear();
+    job.results.resize(num_threads);
+
+    std::vector<std::function<void()>> tasks;
+    uint64_t chunk = count / num_threads;
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        uint64_t b = i * chunk;
+        uint64_t e = (i == num_threads - 1) ? count : b + chunk;
+        tasks.emplace_back([&job, first, b, e, i] { worker_wide(job, first, b, e, static_cast<int>(i)); });
+    }
+    collatz_pool_run(tasks);
+    auto joined = CollatzClock::now();
+
+    LongestRecords longest;
+    WideThreadResult total;
+    {
+        COLLATZ_TRACE_SCOPE("merge phase");
+        for (const auto& res : job.results) {
+            longest.merge(res.longest);
+            if (res.peak_offset != UINT64_MAX) total.push_peak(res.peak_offset, res.peak);
+            total.overflow_count += res.overflow_count;
+            total.first_overflow_offset = std::min(total.first_overflow_offset, res.first_overflow_offset);
+        }
+    }
+    auto merged = CollatzClock::now();
+
+    longest.sorted(out.top_longest);
+    out.longest_len = static_cast<uint32_t>(out.top_longest[0].value);
+    out.longest_seed = longest.count ? u128_add(first, out.top_longest[0].seed) : CollatzU128{0, 0};
+    out.max_peak = total.peak;
+    out.max_peak_seed = total.peak_offset != UINT64_MAX ? u128_add(first, total.peak_offset) : CollatzU128{0, 0};
+    out.overflow_count = total.overflow_count;
+    out.first_overflow = total.overflow_count ? u128_add(first, total.first_overflow_offset) : CollatzU128{0, 0};
+
+    out.compute_seconds = collatz_seconds_between(start_time, joined);
+    out.merge_seconds = collatz_seconds_between(joined, merged);
+    out.seconds = out.cache_build_seconds + out.compute_seconds + out.merge_seconds;
+    out.throughput = out.seconds > 0 ? (count / out.seconds / 1e9) : 0.0;
+
+    oss.str("");
+    oss << "  ✓ Wide window done in " << std::fixed << std::setprecision(3) << out.compute_seconds << "s ("
+        << std::setprecision(1) << (out.compute_seconds > 0 ? count / out.compute_seconds / 1e6 : 0.0)
+        << " M seeds/s)\n";
+    write_to_log_wide(job.log_fd, oss.str());
+    return 0;
+}
+
+int collatz_compute_wide(CollatzU128 first, uint64_t count, CollatzWideResult& out, int countThread) {
+    WideJob job;
+    return compute_wide_job(job, first, count, out, countThread);
+}
+
+void collatz_wide_set_logging_enabled(bool enabled) {
+    g_wide_logging_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+// ================= PIPE ENTRY =================
+extern "C" int collatz_compute_wide_and_write_pipe(int countThread, uint64_t first_hi, uint64_t first_lo,
+                                                   uint64_t count, int result_fd, int log_fd) {
+    CollatzWideResult result{};
+    WideJob job;
+    job.log_fd = log_fd;
+
+    int ret = compute_wide_job(job, CollatzU128{first_hi, first_lo}, count, result, countThread);
+
+    if (result_fd != -1) {
+        ssize_t bytes_written = write(result_fd, &result, sizeof(result));
+        close(result_fd);
+        if (bytes_written != static_cast<ssize_t>(sizeof(result))) ret = -2;
+    }
+    if (log_fd != -1) {
+        close(log_fd);
+    }
+    return ret;
+}
@@ -0,0 +1,55 @@
+#ifndef COLLATZ_WIDE_H
+#define COLLATZ_WIDE_H
+
+#include <cstdint>
+#include <string>
+#include "collatz.h"
+
+// 128-bit value as two 64-bit limbs
+struct CollatzU128 {
+    uint64_t hi;
+    uint64_t lo;
+};
+
+// Wide range mode: odd seeds of a window anywhere below 2^128, walked in two-limb
+// arithmetic (AVX2 when the build targets it, portable scalar otherwise). Steps and
+// peaks are exact; peaks follow the hybrid kernel (largest 3n+1 on the trajectory).
+struct CollatzWideResult {
+    CollatzU128 first;              // window is first .. first + count - 1
+    uint64_t count;
+    uint32_t longest_len;
+    CollatzU128 longest_seed;
+    CollatzU128 max_peak;
+    CollatzU128 max_peak_seed;
+    // Best first, seeds given as offsets from first; unused slots are zero
+    CollatzRecord top_longest[COLLATZ_TOP_K];
+    // Seeds whose 3n+1 would not fit in 128 bits; they are left out of the records
+    uint64_t overflow_count;
+    CollatzU128 first_overflow;
+    double cache_build_seconds;
+    double compute_seconds;
+    double merge_seconds;
+    double seconds;
+    double throughput;              // billion seeds per second, like CollatzResult
+};
+
+// count is at most 2^63 and the window must end below 2^128; -1 otherwise
+int collatz_compute_wide(CollatzU128 first, uint64_t count, CollatzWideResult& out, int countThread);
+void collatz_wide_set_logging_enabled(bool enabled);
+
+// Decimal or 0x-prefixed hex; false on junk or if the value does not fit
+bool collatz_u128_parse(const std::string& text, CollatzU128& out);
+std::string collatz_u128_to_string(CollatzU128 v);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int collatz_compute_wide_and_write_pipe(int countThread, uint64_t first_hi, uint64_t first_lo,
+                                        uint64_t count, int result_fd, int log_fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COLLATZ_WIDE_H
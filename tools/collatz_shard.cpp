@@ -0,0 +1,138 @@
+// Split a range across machines by hand:
+//   collatz_shard run <first> <last> <shard> [--threads N] [--lanes N] [--all]
+//   collatz_shard merge <out> <shard|directory>...
+//   collatz_shard show <shard>
+// Results are printed as JSON (collatz_result_to_json) on stdout, problems on stderr.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <filesystem>
+#include <chrono>
+#include "collatz.h"
+#include "collatz_summary.h"
+#include "collatz_tune.h"
+
+static int usage() {
+    std::cerr << "usage: collatz_shard run <first> <last> <shard> [--threads N] [--lanes N] [--all]\n"
+                 "       collatz_shard merge <out> <shard|directory>...\n"
+                 "       collatz_shard show <shard>\n";
+    return 2;
+}
+
+static bool parse_u64(const char* text, uint64_t& out) {
+    char* end = nullptr;
+    out = std::strtoull(text, &end, 10);
+    return end && end != text && *end == 0;
+}
+
+static void print_summary(const CollatzSummary& s) {
+    CollatzResult r{};
+    collatz_summary_fill_result(s, r);
+    r.compute_seconds = s.compute_seconds;
+    std::cout << collatz_result_to_json(r) << "\n";
+}
+
+static int cmd_run(int argc, char** argv) {
+    uint64_t first = 0, last = 0;
+    if (argc < 5 || !parse_u64(argv[2], first) || !parse_u64(argv[3], last) || first == 0 || last < first) {
+        return usage();
+    }
+    std::string path = argv[4];
+
+    CollatzOptions opts;
+    for (int i = 5; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) opts.threads = std::atoi(argv[++i]);
+        else if (arg == "--lanes" && i + 1 < argc) opts.lanes = std::atoi(argv[++i]);
+        else if (arg == "--all") opts.all_seeds = true;
+        else return usage();
+    }
+
+    CollatzResult result{};
+    collatz_set_logging_enabled(false);
+    if (collatz_compute_range(first, last, result, opts) != 0) return 1;
+
+    CollatzSummary summary;
+    collatz_summary_from_result(result, first, COLLATZ_KERNEL_HYBRID, summary);
+    if (!collatz_shard_write(summary, path)) {
+        std::cerr << "cannot write " << path << "\n";
+        return 1;
+    }
+    print_summary(summary);
+    return 0;
+}
+
+static int cmd_merge(int argc, char** argv) {
+    if (argc < 4) return usage();
+    std::string out_path = argv[2];
+    auto start = std::chrono::steady_clock::now();
+
+    // Directories contribute every regular file in them
+    std::vector<std::string> paths;
+    for (int i = 3; i < argc; ++i) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(argv[i], ec)) {
+            for (const auto& entry : std::filesystem::directory_iterator(argv[i], ec)) {
+                if (entry.is_regular_file()) paths.push_back(entry.path().string());
+            }
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    CollatzShardMerge merge;
+    CollatzSummary shard;
+    int bad = 0;
+    for (const std::string& path : paths) {
+        if (!collatz_shard_read(path, shard)) {
+            std::cerr << "not a shard: " << path << "\n";
+            ++bad;
+        } else if (!collatz_shard_merge_add(merge, shard)) {
+            std::cerr << "kernel or seed mode differs from the other shards: " << path << "\n";
+            ++bad;
+        }
+    }
+    if (merge.ranges.empty()) {
+        std::cerr << "no shards\n";
+        return 1;
+    }
+
+    std::vector<CollatzRangeIssue> issues;
+    collatz_shard_merge_finish(merge, issues);
+    for (const CollatzRangeIssue& issue : issues) {
+        std::cerr << (issue.overlap ? "overlap " : "gap ") << format_number(issue.first) << " .. "
+                  << format_number(issue.last) << "\n";
+    }
+    // A gap or overlap would make the combined stats describe some other set of seeds
+    if (bad || !issues.empty()) return 1;
+
+    if (!collatz_shard_write(merge.total, out_path)) {
+        std::cerr << "cannot write " << out_path << "\n";
+        return 1;
+    }
+    std::cerr << "merged " << merge.ranges.size() << " shards covering " << format_number(merge.total.first)
+              << " .. " << format_number(merge.total.last) << " in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+    print_summary(merge.total);
+    return 0;
+}
+
+static int cmd_show(int argc, char** argv) {
+    CollatzSummary s;
+    if (argc != 3 || !collatz_shard_read(argv[2], s)) return usage();
+    std::cerr << format_number(s.first) << " .. " << format_number(s.last)
+              << (s.all_seeds ? ", all seeds" : ", odd seeds")
+              << (s.kernel == COLLATZ_KERNEL_SIMD ? ", SIMD\n" : ", hybrid\n");
+    print_summary(s);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage();
+    std::string cmd = argv[1];
+    if (cmd == "run") return cmd_run(argc, argv);
+    if (cmd == "merge") return cmd_merge(argc, argv);
+    if (cmd == "show") return cmd_show(argc, argv);
+    return usage();
+}